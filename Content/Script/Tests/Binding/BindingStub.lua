@@ -0,0 +1,9 @@
+require "UnLua"
+
+local M = Class()
+
+function M:Initialize()
+    NumBound = (NumBound or 0) + 1
+end
+
+return M
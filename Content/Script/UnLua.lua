@@ -60,4 +60,5 @@ local function Class(super_name)
   return new_class
 end
 
-_G.Class = Class
\ No newline at end of file
+-- keep the native Class registered by UnLua (UUnLuaSettings::bNativeClass), it behaves the same as the one above
+_G.Class = rawget(_G, "Class") or Class
\ No newline at end of file
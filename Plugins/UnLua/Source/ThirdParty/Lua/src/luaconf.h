@@ -726,6 +726,13 @@
 */
 #define LUA_EXTRASPACE		(sizeof(void *))
 
+/*
+** UnLua: the extra space of a new state is zeroed, UnLua::FLuaEnv::FindEnv
+** reads it to find the env of a state and must get NULL for other states.
+** Threads copy the extra space of their main thread.
+*/
+#define luai_userstateopen(L)	memset(lua_getextraspace(L), 0, LUA_EXTRASPACE)
+
 
 /*
 @@ LUA_IDSIZE gives the maximum size for the description of the source
@@ -14,6 +14,7 @@
 
 #include "UnLuaEx.h"
 #include "LuaCore.h"
+#include "Registries/ClassRegistry.h"
 #include "Kismet/DataTableFunctionLibrary.h"
 
 
@@ -57,10 +58,8 @@ namespace UnLua
 			const UScriptStruct* StructType = Table->GetRowStruct();
 
 			if (StructType != nullptr) {
-				FString Name = FString("F" + StructType->GetName());
-				uint8 StructPadding = StructType->GetMinAlignment();
-				uint8 Padding = StructPadding < 8 ? 8 : StructPadding;
-				void* Userdata = NewUserdataWithPadding(L, StructType->GetStructureSize(), TCHAR_TO_UTF8(*Name), Padding);
+				FClassDesc* ClassDesc = UnLua::FClassRegistry::RegisterReflectedType((UScriptStruct*)StructType);
+				void* Userdata = ClassDesc ? NewUserdataWithPadding(L, ClassDesc) : nullptr;
 				if (Userdata != nullptr) {
 					if (StructType->StructFlags & STRUCT_CopyNative) {
 						//Do ScriptStruct Construct
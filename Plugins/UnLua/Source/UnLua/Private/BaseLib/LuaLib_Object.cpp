@@ -112,8 +112,7 @@ static int32 UObject_GetName(lua_State *L)
         return 0;
     }
 
-    FString Name = Object->GetName();
-    lua_pushstring(L, TCHAR_TO_UTF8(*Name));
+    UnLua::FLuaEnv::FindEnvChecked(L).GetNameRegistry()->Push(L, Object->GetFName());
     return 1;
 }
 
@@ -293,6 +292,8 @@ static const luaL_Reg UObjectLib[] =
     { "GetClass", UObject_GetClass },
     { "GetWorld", UObject_GetWorld },
     { "IsA", UObject_IsA },
+    { "GetProperties", Class_GetProperties },
+    { "SetProperties", Class_SetProperties },
     { "Release", UObject_Release },
     { "Destroy", UObject_Release },
     { "__eq", UObject_Identical },
@@ -0,0 +1,210 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+#include "LuaAllocProfiler.h"
+#include "LuaEnv.h"
+
+namespace UnLua
+{
+    static void SortByBytes(TArray<FAllocProfiler::FSiteStats>& Stats)
+    {
+        Stats.Sort([](const FAllocProfiler::FSiteStats& A, const FAllocProfiler::FSiteStats& B) { return A.Bytes > B.Bytes; });
+    }
+
+    FAllocProfiler::FAllocProfiler(FLuaEnv* Env)
+        : Env(Env)
+    {
+    }
+
+    FAllocProfiler::~FAllocProfiler()
+    {
+        Stop();
+    }
+
+    void FAllocProfiler::Start(int32 InSampleInterval)
+    {
+        if (bRunning)
+            return;
+
+        Reset();
+        lua_State* L = Env->GetMainState();
+        SampleInterval = FMath::Max(InSampleInterval, 1);
+        BytesUntilSample = SampleInterval;
+        OriginalAlloc = lua_getallocf(L, &OriginalUserData);
+        lua_setallocf(L, Alloc, this);
+        bRunning = true;
+    }
+
+    void FAllocProfiler::Stop()
+    {
+        if (!bRunning)
+            return;
+
+        // blocks sampled so far are freed by the original allocator from now on, their stats are kept until the next start
+        lua_setallocf(Env->GetMainState(), OriginalAlloc, OriginalUserData);
+        Samples.Empty();
+        bRunning = false;
+    }
+
+    void FAllocProfiler::Reset()
+    {
+        Samples.Empty();
+        Sites.Empty();
+        SiteIndices.Empty();
+        LiveStats.Empty();
+        Snapshots.Empty();
+    }
+
+    void* FAllocProfiler::Alloc(void* UserData, void* Ptr, size_t OldSize, size_t NewSize)
+    {
+        FAllocProfiler* Profiler = (FAllocProfiler*)UserData;
+
+        // the stack must be walked before calling the allocator, which may be moving it
+        const int64 Growth = (int64)NewSize - (Ptr ? (int64)OldSize : 0);
+        int32 Site = INDEX_NONE;
+        if (Growth > 0)
+        {
+            Profiler->BytesUntilSample -= Growth;
+            if (Profiler->BytesUntilSample <= 0)
+            {
+                Profiler->BytesUntilSample = Profiler->SampleInterval;
+                Site = Profiler->FindOrAddSite(Ptr ? LUA_TNONE : (int32)OldSize);
+            }
+        }
+
+        void* NewPtr = Profiler->OriginalAlloc(Profiler->OriginalUserData, Ptr, OldSize, NewSize);
+
+        FSample Sample;
+        if (Ptr && Profiler->Samples.RemoveAndCopyValue(Ptr, Sample))
+        {
+            FSiteStats& Stats = Profiler->LiveStats[Sample.Site];
+            if (NewPtr)
+            {
+                // reallocated blocks stay with the site they were sampled at
+                const int64 Weight = FMath::Max<int64>(Profiler->SampleInterval, NewSize);
+                Stats.Bytes += Weight - Sample.Weight;
+                Sample.Weight = Weight;
+                Profiler->Samples.Add(NewPtr, Sample);
+                return NewPtr;
+            }
+
+            Stats.Bytes -= Sample.Weight;
+            Stats.Count--;
+        }
+
+        if (Site != INDEX_NONE && NewPtr)
+        {
+            // a sample stands for all the bytes allocated since the previous one
+            Sample.Site = Site;
+            Sample.Weight = FMath::Max<int64>(Profiler->SampleInterval, NewSize);
+            Profiler->Samples.Add(NewPtr, Sample);
+
+            FSiteStats& Stats = Profiler->LiveStats[Site];
+            Stats.Bytes += Sample.Weight;
+            Stats.Count++;
+        }
+        return NewPtr;
+    }
+
+    int32 FAllocProfiler::FindOrAddSite(int32 Type)
+    {
+        // allocations are made by the running thread, coroutines are attributed to the line resuming them
+        lua_State* L = Env->GetMainState();
+        lua_Debug ar;
+        FString Location = TEXT("[C]");
+        for (int32 Level = 0; lua_getstack(L, Level, &ar); ++Level)
+        {
+            lua_getinfo(L, "Sl", &ar);
+            if (ar.currentline > 0)
+            {
+                Location = FString::Printf(TEXT("%s:%d"), UTF8_TO_TCHAR(ar.short_src), ar.currentline);
+                break;
+            }
+        }
+
+        // the type of the object being created, or none for buffers (table parts, stacks, strings being built...)
+        const char* TypeName = Type > LUA_TNIL && Type < LUA_NUMTAGS ? lua_typename(L, Type) : "buffer";
+        const FString Key = Location + TEXT("|") + TypeName;
+        if (const int32* Index = SiteIndices.Find(Key))
+            return *Index;
+
+        const int32 Index = Sites.Add({Location, TypeName});
+        LiveStats.Add({Index, 0, 0});
+        SiteIndices.Add(Key, Index);
+        return Index;
+    }
+
+    int32 FAllocProfiler::TakeSnapshot()
+    {
+        return Snapshots.Add(LiveStats);
+    }
+
+    TArray<FAllocProfiler::FSiteStats> FAllocProfiler::GetLive() const
+    {
+        TArray<FSiteStats> Result;
+        for (const auto& Stats : LiveStats)
+        {
+            if (Stats.Count != 0)
+                Result.Add(Stats);
+        }
+        SortByBytes(Result);
+        return Result;
+    }
+
+    TArray<FAllocProfiler::FSiteStats> FAllocProfiler::Diff(int32 From, int32 To) const
+    {
+        TArray<FSiteStats> Result;
+        if (!Snapshots.IsValidIndex(From) || !Snapshots.IsValidIndex(To))
+            return Result;
+
+        // sites are only appended, a snapshot covers every site known when it was taken
+        const auto& Before = Snapshots[From];
+        const auto& After = Snapshots[To];
+        const int32 NumSites = FMath::Max(Before.Num(), After.Num());
+        for (int32 i = 0; i < NumSites; i++)
+        {
+            const int64 Bytes = (After.IsValidIndex(i) ? After[i].Bytes : 0) - (Before.IsValidIndex(i) ? Before[i].Bytes : 0);
+            const int64 Count = (After.IsValidIndex(i) ? After[i].Count : 0) - (Before.IsValidIndex(i) ? Before[i].Count : 0);
+            if (Bytes != 0 || Count != 0)
+                Result.Add({i, Bytes, Count});
+        }
+        SortByBytes(Result);
+        return Result;
+    }
+
+    FString FAllocProfiler::ToCSV(const TArray<FSiteStats>& Stats) const
+    {
+        FString Result = TEXT("Location,Type,Bytes,Count\n");
+        for (const auto& Stat : Stats)
+        {
+            const FSite& Site = Sites[Stat.Site];
+            Result += FString::Printf(TEXT("\"%s\",%s,%lld,%lld\n"), *Site.Location.Replace(TEXT("\""), TEXT("\"\"")), UTF8_TO_TCHAR(Site.Type), Stat.Bytes, Stat.Count);
+        }
+        return Result;
+    }
+
+    FString FAllocProfiler::ToJSON(const TArray<FSiteStats>& Stats) const
+    {
+        FString Result = TEXT("[\n");
+        for (int32 i = 0; i < Stats.Num(); i++)
+        {
+            const FSite& Site = Sites[Stats[i].Site];
+            const FString Location = Site.Location.Replace(TEXT("\\"), TEXT("\\\\")).Replace(TEXT("\""), TEXT("\\\""));
+            Result += FString::Printf(TEXT("  {\"location\": \"%s\", \"type\": \"%s\", \"bytes\": %lld, \"count\": %lld}%s\n"),
+                *Location, UTF8_TO_TCHAR(Site.Type), Stats[i].Bytes, Stats[i].Count, i + 1 < Stats.Num() ? TEXT(",") : TEXT(""));
+        }
+        Result += TEXT("]\n");
+        return Result;
+    }
+}
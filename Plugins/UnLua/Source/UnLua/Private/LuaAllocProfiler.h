@@ -0,0 +1,103 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "lua.hpp"
+
+namespace UnLua
+{
+    class FLuaEnv;
+
+    /**
+     * Sampling profiler of Lua allocations.
+     * While running, the allocator of the Lua state is wrapped to pick one allocation every 'SampleInterval' bytes,
+     * attribute it to the innermost Lua source:line of the main thread and the type of the object, and follow it
+     * until it's freed. The original allocator is restored when stopped, so there's no cost at all when not running.
+     */
+    class UNLUA_API FAllocProfiler
+    {
+    public:
+        static constexpr int32 DefaultSampleInterval = 16 * 1024;
+
+        struct FSite
+        {
+            FString Location;
+            const char* Type;
+        };
+
+        /** estimated live memory of a call site, or its growth between two snapshots */
+        struct FSiteStats
+        {
+            int32 Site;
+            int64 Bytes;
+            int64 Count;
+        };
+
+        explicit FAllocProfiler(FLuaEnv* Env);
+
+        ~FAllocProfiler();
+
+        void Start(int32 InSampleInterval = DefaultSampleInterval);
+
+        void Stop();
+
+        FORCEINLINE bool IsRunning() const { return bRunning; }
+
+        FORCEINLINE int32 GetSampleInterval() const { return SampleInterval; }
+
+        FORCEINLINE const FSite& GetSite(int32 Index) const { return Sites[Index]; }
+
+        /** @return - index of the snapshot */
+        int32 TakeSnapshot();
+
+        FORCEINLINE int32 NumSnapshots() const { return Snapshots.Num(); }
+
+        /** live memory by call site, largest first */
+        TArray<FSiteStats> GetLive() const;
+
+        /** memory retained by call site from one snapshot to another, largest growth first */
+        TArray<FSiteStats> Diff(int32 From, int32 To) const;
+
+        FString ToCSV(const TArray<FSiteStats>& Stats) const;
+
+        FString ToJSON(const TArray<FSiteStats>& Stats) const;
+
+    private:
+        struct FSample
+        {
+            int32 Site;
+            int64 Weight;
+        };
+
+        static void* Alloc(void* UserData, void* Ptr, size_t OldSize, size_t NewSize);
+
+        int32 FindOrAddSite(int32 Type);
+
+        void Reset();
+
+        FLuaEnv* Env;
+        bool bRunning = false;
+        int32 SampleInterval = DefaultSampleInterval;
+        int64 BytesUntilSample = 0;
+        lua_Alloc OriginalAlloc = nullptr;
+        void* OriginalUserData = nullptr;
+        TMap<void*, FSample> Samples;
+        TArray<FSite> Sites;
+        TMap<FString, int32> SiteIndices;
+        TArray<FSiteStats> LiveStats;   // indexed by site
+        TArray<TArray<FSiteStats>> Snapshots;
+    };
+}
@@ -0,0 +1,139 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+#include "LuaAllocator.h"
+#include "UnLuaPrivate.h"
+
+bool GLuaPooledAllocator = false;
+
+namespace UnLua
+{
+    FLuaAllocator::~FLuaAllocator()
+    {
+        DEC_MEMORY_STAT_BY(STAT_UnLua_LuaAllocator_Slab_Memory, GetSlabMemory());
+        for (void* Slab : Slabs)
+            FMemory::Free(Slab);
+    }
+
+    void* FLuaAllocator::Alloc(void* UserData, void* Ptr, size_t OldSize, size_t NewSize)
+    {
+        FLuaAllocator* Allocator = (FLuaAllocator*)UserData;
+        if (NewSize == 0)
+        {
+            if (Ptr)
+                Allocator->Free(Ptr, OldSize);
+            return nullptr;
+        }
+
+        // 'OldSize' is the type of the object being created when 'Ptr' is null
+        if (!Ptr)
+            return Allocator->Malloc(NewSize);
+
+        return Allocator->Realloc(Ptr, OldSize, NewSize);
+    }
+
+    int64 FLuaAllocator::GetSlabMemory() const
+    {
+        return (int64)Slabs.Num() * SlabSize;
+    }
+
+    void* FLuaAllocator::Malloc(size_t Size)
+    {
+        INC_MEMORY_STAT_BY(STAT_UnLua_Lua_Memory, Size);
+        if (Size <= MaxSmallSize)
+            return AllocSmall(GetSizeClass(Size));
+
+        ++NumLargeBlocks;
+        return FMemory::Malloc(Size);
+    }
+
+    void FLuaAllocator::Free(void* Ptr, size_t Size)
+    {
+        DEC_MEMORY_STAT_BY(STAT_UnLua_Lua_Memory, Size);
+        if (Size <= MaxSmallSize)
+        {
+            FreeSmall(Ptr, GetSizeClass(Size));
+            return;
+        }
+
+        --NumLargeBlocks;
+        FMemory::Free(Ptr);
+    }
+
+    void* FLuaAllocator::Realloc(void* Ptr, size_t OldSize, size_t NewSize)
+    {
+        if (OldSize > MaxSmallSize && NewSize > MaxSmallSize)
+        {
+            if (NewSize > OldSize)
+                INC_MEMORY_STAT_BY(STAT_UnLua_Lua_Memory, NewSize - OldSize);
+            else
+                DEC_MEMORY_STAT_BY(STAT_UnLua_Lua_Memory, OldSize - NewSize);
+            return FMemory::Realloc(Ptr, NewSize);
+        }
+
+        if (OldSize <= MaxSmallSize && NewSize <= MaxSmallSize && GetSizeClass(OldSize) == GetSizeClass(NewSize))
+        {
+            if (NewSize > OldSize)
+                INC_MEMORY_STAT_BY(STAT_UnLua_Lua_Memory, NewSize - OldSize);
+            else
+                DEC_MEMORY_STAT_BY(STAT_UnLua_Lua_Memory, OldSize - NewSize);
+            return Ptr;
+        }
+
+        // moving between a slab and the heap, or between size classes
+        void* NewPtr = Malloc(NewSize);
+        FMemory::Memcpy(NewPtr, Ptr, FMath::Min(OldSize, NewSize));
+        Free(Ptr, OldSize);
+        return NewPtr;
+    }
+
+    void* FLuaAllocator::AllocSmall(int32 SizeClass)
+    {
+        FSizeClass& Class = SizeClasses[SizeClass];
+        void* Block;
+        if (Class.FreeList)
+        {
+            Block = Class.FreeList;
+            Class.FreeList = Class.FreeList->Next;
+        }
+        else
+        {
+            const int32 BlockSize = GetBlockSize(SizeClass);
+            if (Class.Cursor + BlockSize > Class.End)
+            {
+                // the tail of the previous slab smaller than a block is left unused
+                Class.Cursor = (uint8*)FMemory::Malloc(SlabSize, Granularity);
+                Class.End = Class.Cursor + SlabSize;
+                Slabs.Add(Class.Cursor);
+                ++Class.Stats.NumSlabs;
+                INC_MEMORY_STAT_BY(STAT_UnLua_LuaAllocator_Slab_Memory, SlabSize);
+            }
+            Block = Class.Cursor;
+            Class.Cursor += BlockSize;
+        }
+
+        if (++Class.Stats.NumLive > Class.Stats.NumPeak)
+            Class.Stats.NumPeak = Class.Stats.NumLive;
+        return Block;
+    }
+
+    void FLuaAllocator::FreeSmall(void* Ptr, int32 SizeClass)
+    {
+        FSizeClass& Class = SizeClasses[SizeClass];
+        FFreeBlock* Block = (FFreeBlock*)Ptr;
+        Block->Next = Class.FreeList;
+        Class.FreeList = Block;
+        --Class.Stats.NumLive;
+    }
+}
@@ -0,0 +1,90 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Whether new Lua envs allocate through FLuaAllocator instead of forwarding every allocation to FMemory, see UUnLuaSettings::bPooledLuaAllocator
+ */
+UNLUA_API extern bool GLuaPooledAllocator;
+
+namespace UnLua
+{
+    /**
+     * Pooled allocator of a Lua state.
+     * Small blocks, which dominate Lua (strings, tables, closures, userdata), are carved from per size class slabs
+     * and recycled through free lists, larger ones are forwarded to FMemory. A Lua state is never used by two threads
+     * at the same time, so no locking is needed. Slabs are kept until the allocator is destroyed with its Lua state.
+     */
+    class UNLUA_API FLuaAllocator
+    {
+    public:
+        static constexpr int32 Granularity = 16;
+        static constexpr int32 MaxSmallSize = 256;
+        static constexpr int32 NumSizeClasses = MaxSmallSize / Granularity;
+        static constexpr int32 SlabSize = 64 * 1024;
+
+        struct FSizeClassStats
+        {
+            int32 NumLive = 0;
+            int32 NumPeak = 0;
+            int32 NumSlabs = 0;
+        };
+
+        ~FLuaAllocator();
+
+        /** lua_Alloc entry, the userdata is the allocator */
+        static void* Alloc(void* UserData, void* Ptr, size_t OldSize, size_t NewSize);
+
+        FORCEINLINE static int32 GetBlockSize(int32 SizeClass) { return (SizeClass + 1) * Granularity; }
+
+        FORCEINLINE const FSizeClassStats& GetStats(int32 SizeClass) const { return SizeClasses[SizeClass].Stats; }
+
+        FORCEINLINE int64 GetNumLargeBlocks() const { return NumLargeBlocks; }
+
+        int64 GetSlabMemory() const;
+
+    private:
+        struct FFreeBlock
+        {
+            FFreeBlock* Next;
+        };
+
+        struct FSizeClass
+        {
+            FFreeBlock* FreeList = nullptr;
+            uint8* Cursor = nullptr;
+            uint8* End = nullptr;
+            FSizeClassStats Stats;
+        };
+
+        FORCEINLINE static int32 GetSizeClass(size_t Size) { return (int32)((Size - 1) / Granularity); }
+
+        void* Malloc(size_t Size);
+
+        void Free(void* Ptr, size_t Size);
+
+        void* Realloc(void* Ptr, size_t OldSize, size_t NewSize);
+
+        void* AllocSmall(int32 SizeClass);
+
+        void FreeSmall(void* Ptr, int32 SizeClass);
+
+        FSizeClass SizeClasses[NumSizeClasses];
+        TArray<void*> Slabs;
+        int64 NumLargeBlocks = 0;
+    };
+}
@@ -39,6 +39,8 @@ const FScriptContainerDesc FScriptContainerDesc::Array(sizeof(FLuaArray), "TArra
 const FScriptContainerDesc FScriptContainerDesc::Set(sizeof(FLuaSet), "TSet");
 const FScriptContainerDesc FScriptContainerDesc::Map(sizeof(FLuaMap), "TMap");
 
+bool GLuaNativeClass = true;
+
 /**
  * Get lua file full path from relative path
  */
@@ -401,6 +403,18 @@ bool TryToSetMetatable(lua_State* L, const char* MetatableName, UObject* Object)
     return Registry->TrySetMetatable(L, MetatableName);
 }
 
+/**
+ * Set metatable for the userdata/table on the top of the stack, through the metatable reference cached on the class descriptor
+ */
+bool TryToSetMetatable(lua_State* L, FClassDesc* ClassDesc)
+{
+    const auto Env = UnLua::FLuaEnv::FindEnv(L);
+    if (!Env)
+        return false;
+
+    return Env->GetClassRegistry()->TrySetMetatable(L, ClassDesc);
+}
+
 /**
  * Create a new userdata with padding size
  */
@@ -551,11 +565,46 @@ void RemoveCachedScriptContainer(lua_State *L, void *Key)
     lua_pop(L, 2);
 }
 
+/**
+ * Create a new userdata for an instance of a script struct
+ */
+void* NewUserdataWithPadding(lua_State* L, FClassDesc* ClassDesc)
+{
+    if (ClassDesc->GetSize() < 1)
+    {
+        UNLUA_LOGERROR(L, LogUnLua, Warning, TEXT("%s, Invalid size!"), ANSI_TO_TCHAR(__FUNCTION__));
+        return nullptr;
+    }
+
+    const uint8 PaddingSize = ClassDesc->GetUserdataPadding();
+    void* Userdata = NewUserdataWithPaddingTag(L, ClassDesc->GetSize(), PaddingSize);
+    if (!TryToSetMetatable(L, ClassDesc))
+    {
+        UNLUA_LOGERROR(L, LogUnLua, Warning, TEXT("%s, Invalid metatable, metatable name: %s!"), ANSI_TO_TCHAR(__FUNCTION__), *ClassDesc->GetName());
+        return nullptr;
+    }
+    return (uint8*)Userdata + PaddingSize;
+}
+
 /**
  * Push a UObject to Lua stack
  */
 void PushObjectCore(lua_State *L, UObjectBaseUtility *Object)
 {
+    if (Object && !Object->IsA<UEnum>())
+    {
+        // fast path, the class descriptor caches the metatable reference
+        const UStruct* Struct = Cast<UStruct>((UObject*)Object);
+        FClassDesc* ClassDesc = UnLua::FClassRegistry::Find(Struct ? Struct : Object->GetClass());
+        if (ClassDesc)
+        {
+            NewUserdataWithTwoLvPtrTag(L, sizeof(void*), Object);
+            if (TryToSetMetatable(L, ClassDesc))
+                return;
+            lua_pop(L, 1);
+        }
+    }
+
     FString MetatableName = UnLua::LowLevel::GetMetatableName((UObject*)Object);
     if (MetatableName.IsEmpty())
     {
@@ -605,7 +654,7 @@ static void PushEnumElement(lua_State *L, FNumericProperty *Property, void *Valu
  */
 static void PushFNameElement(lua_State *L, FNameProperty *Property, void *Value)
 {
-    lua_pushstring(L, TCHAR_TO_UTF8(*Property->GetPropertyValue(Value).ToString()));
+    UnLua::FLuaEnv::FindEnvChecked(L).GetNameRegistry()->Push(L, Property->GetPropertyValue(Value));
 }
 
 /**
@@ -959,6 +1008,7 @@ bool PushFunction(lua_State *L, UObjectBaseUtility *Object, int32 FunctionRef)
  */
 bool CallFunction(lua_State *L, int32 NumArgs, int32 NumResults)
 {
+    const UnLua::FParamArena::FScope ParamScope(UnLua::FLuaEnv::FindEnvChecked(L).GetParamArena());
     int32 ErrorReporterIdx = lua_gettop(L) - NumArgs - 1;
     int32 Code = lua_pcall(L, NumArgs, NumResults, -(NumArgs + 2));
     if (Code == LUA_OK)
@@ -999,26 +1049,25 @@ static void PushField(lua_State *L, TSharedPtr<FFieldDesc> Field)
 }
 
 /**
- * Get a field (property or function)
+ * Push a field (property or function) of the class whose metatable is at the given index, the field is resolved once and cached in the metatable
+ *
+ * @return - Lua type of the pushed field
  */
-static int32 GetField(lua_State* L)
+static int32 GetField(lua_State* L, int32 MetatableIndex, int32 KeyIndex)
 {
-    int32 Type = lua_getmetatable(L, 1);       // get meta table of table/userdata (first parameter passed in)
-    check(Type == 1 && lua_istable(L, -1));
-
-    lua_pushvalue(L, 2);                    // push key
-    Type = lua_rawget(L, -2);
+    lua_pushvalue(L, KeyIndex);             // push key
+    int32 Type = lua_rawget(L, MetatableIndex);
 
     if (Type == LUA_TNIL)
     {
         lua_pop(L, 1);
 
         lua_pushstring(L, "__name");
-        Type = lua_rawget(L, -2);
+        Type = lua_rawget(L, MetatableIndex);
         check(Type == LUA_TSTRING);
 
         const char* ClassName = lua_tostring(L, -1);
-        const char* FieldName = lua_tostring(L, 2);
+        const char* FieldName = lua_tostring(L, KeyIndex);
 
         lua_pop(L, 1);
 
@@ -1035,7 +1084,7 @@ static int32 GetField(lua_State* L)
                 FString SuperStructName = Field->GetOuterName();
                 const auto Pushed = Registry->PushMetatable(L, TCHAR_TO_UTF8(*SuperStructName));
                 check(Pushed);
-                lua_pushvalue(L, 2);
+                lua_pushvalue(L, KeyIndex);
                 Type = lua_rawget(L, -2);
                 bCached = Type != LUA_TNIL;
                 if (!bCached)
@@ -1047,16 +1096,16 @@ static int32 GetField(lua_State* L)
             if (!bCached)
             {
                 PushField(L, Field);                // Property / closure
-                lua_pushvalue(L, 2);                // key
+                lua_pushvalue(L, KeyIndex);         // key
                 lua_pushvalue(L, -2);               // Property / closure
-                lua_rawset(L, -4);
+                lua_rawset(L, bInherited ? -4 : MetatableIndex);
             }
             if (bInherited)
             {
                 lua_remove(L, -2);
-                lua_pushvalue(L, 2);                // key
+                lua_pushvalue(L, KeyIndex);         // key
                 lua_pushvalue(L, -2);               // Property / closure
-                lua_rawset(L, -4);
+                lua_rawset(L, MetatableIndex);
             }
         }
         else
@@ -1064,7 +1113,7 @@ static int32 GetField(lua_State* L)
             if (ClassDesc->IsClass())
             {
                 luaL_getmetatable(L, "UClass");
-                lua_pushvalue(L, 2);                // push key
+                lua_pushvalue(L, KeyIndex);         // push key
                 lua_rawget(L, -2);
                 lua_remove(L, -2);
             }
@@ -1074,6 +1123,18 @@ static int32 GetField(lua_State* L)
             }
         }
     }
+    return lua_type(L, -1);
+}
+
+/**
+ * Get a field (property or function)
+ */
+static int32 GetField(lua_State* L)
+{
+    int32 Type = lua_getmetatable(L, 1);       // get meta table of table/userdata (first parameter passed in)
+    check(Type == 1 && lua_istable(L, -1));
+
+    GetField(L, lua_gettop(L), 2);
     lua_remove(L, -2);
     return 1;
 }
@@ -1393,6 +1454,150 @@ int32 Global_SetUProperty(lua_State *L)
     return 0;
 }
 
+/**
+ * Get a member of a Lua class, the same as 'Class[Key]' except that fields already
+ * resolved by Class_Index are read from the metatable without calling it
+ */
+static int32 GetClassMember(lua_State *L, int32 ClassIndex, int32 KeyIndex)
+{
+    lua_pushvalue(L, KeyIndex);
+    int32 Type = lua_rawget(L, ClassIndex);
+    if (Type != LUA_TNIL)
+        return Type;
+    lua_pop(L, 1);
+
+    if (lua_getmetatable(L, ClassIndex))
+    {
+        lua_pushvalue(L, KeyIndex);
+        Type = lua_rawget(L, -2);
+        if (Type != LUA_TNIL)
+        {
+            lua_remove(L, -2);
+            return Type;
+        }
+        lua_pop(L, 2);
+    }
+
+    lua_pushvalue(L, KeyIndex);
+    return lua_gettable(L, ClassIndex);
+}
+
+/**
+ * __index meta method of Lua classes, the native version of 'Index' in UnLua.lua
+ */
+static int32 LuaClass_Index(lua_State *L)
+{
+    if (!lua_getmetatable(L, 1))
+        return 0;
+
+    // walk the 'Super' chain, skipping names known not to exist
+    const int32 ClassIndex = lua_gettop(L);
+    lua_pushvalue(L, ClassIndex);
+    while (lua_istable(L, -1))
+    {
+        lua_pushvalue(L, 2);
+        if (lua_rawget(L, -2) != LUA_TNIL && !lua_rawequal(L, -1, lua_upvalueindex(1)))
+        {
+            lua_pushvalue(L, 2);
+            lua_pushvalue(L, -2);
+            lua_rawset(L, 1);
+            return 1;
+        }
+        lua_pop(L, 1);
+        lua_pushstring(L, "Super");
+        lua_rawget(L, -2);
+        lua_remove(L, -2);
+    }
+    lua_pop(L, 1);
+
+    const int32 Type = GetClassMember(L, ClassIndex, 2);
+    switch (Type)
+    {
+    case LUA_TUSERDATA:
+        {
+            // property, read it directly instead of going through GetUProperty
+            const TSharedPtr<UnLua::ITypeOps>& Property = *(TSharedPtr<UnLua::ITypeOps>*)UnLua::GetSmartPointer(L, -1);
+            void* Self = GetCppInstance(L, 1);
+            if (!Property.IsValid() || !Self)
+                return 0;
+            Property->Read(L, Self, false);
+            return 1;
+        }
+    case LUA_TFUNCTION:
+        lua_pushvalue(L, 2);
+        lua_pushvalue(L, -2);
+        lua_rawset(L, 1);
+        return 1;
+    case LUA_TNIL:
+        lua_pushvalue(L, 2);
+        lua_pushvalue(L, lua_upvalueindex(1));
+        lua_rawset(L, ClassIndex);
+        return 1;
+    case LUA_TLIGHTUSERDATA:
+        return 0;
+    default:
+        return lua_rawequal(L, -1, lua_upvalueindex(1)) ? 0 : 1;
+    }
+}
+
+/**
+ * __newindex meta method of Lua classes, the native version of 'NewIndex' in UnLua.lua
+ */
+static int32 LuaClass_NewIndex(lua_State *L)
+{
+    if (lua_getmetatable(L, 1) && GetClassMember(L, 4, 2) == LUA_TUSERDATA)
+    {
+        const TSharedPtr<UnLua::ITypeOps>& Property = *(TSharedPtr<UnLua::ITypeOps>*)UnLua::GetSmartPointer(L, -1);
+        UObject* Object = UnLua::GetUObject(L, 1);
+        if (Property.IsValid() && Object)
+            Property->Write(L, Object, 3);
+        return 0;
+    }
+
+    lua_settop(L, 3);
+    lua_rawset(L, 1);
+    return 0;
+}
+
+/**
+ * Create a Lua class, the native version of 'Class' in UnLua.lua
+ */
+static int32 Global_Class(lua_State *L)
+{
+    const bool bHasSuper = !lua_isnoneornil(L, 1);
+    lua_settop(L, 1);
+    if (bHasSuper)
+    {
+        lua_getglobal(L, "require");
+        lua_pushvalue(L, 1);
+        lua_call(L, 1, 1);
+    }
+
+    lua_createtable(L, 0, 3);
+    lua_pushvalue(L, lua_upvalueindex(1));
+    lua_setfield(L, -2, "__index");
+    lua_pushvalue(L, lua_upvalueindex(2));
+    lua_setfield(L, -2, "__newindex");
+    if (bHasSuper)
+    {
+        lua_pushvalue(L, 2);
+        lua_setfield(L, -2, "Super");
+    }
+    return 1;
+}
+
+/**
+ * Register the native 'Class', the stock UnLua.lua keeps it while a customized one may replace it
+ */
+void RegisterNativeClass(lua_State *L)
+{
+    lua_newtable(L);                                        // 'NotExist' sentinel
+    lua_pushcclosure(L, LuaClass_Index, 1);
+    lua_pushcfunction(L, LuaClass_NewIndex);
+    lua_pushcclosure(L, Global_Class, 2);
+    lua_setglobal(L, "Class");
+}
+
 extern int32 UObject_Load(lua_State *L);
 extern int32 UClass_Load(lua_State *L);
 
@@ -1568,6 +1773,7 @@ int32 Enum_GetNameStringByValue(lua_State* L)
     }
 
     FString ValueName;
+    FName ShortName;
 
     lua_pushvalue(L, lua_upvalueindex(1));
     if (lua_type(L, -1) == LUA_TTABLE)
@@ -1586,7 +1792,9 @@ int32 Enum_GetNameStringByValue(lua_State* L)
                 UEnum* Enum = EnumDesc->GetEnum();
                 if (Enum)
                 {   
-                    ValueName = Enum->GetNameStringByValue(Value);
+                    ShortName = EnumDesc->GetShortName(Enum->GetIndexByValue(Value));
+                    if (ShortName.IsNone())
+                        ValueName = Enum->GetNameStringByValue(Value);
                 }
             }
         }
@@ -1594,7 +1802,10 @@ int32 Enum_GetNameStringByValue(lua_State* L)
     }
     lua_pop(L, 1);
 
-    UnLua::Push(L, ValueName);
+    if (ShortName.IsNone())
+        UnLua::Push(L, ValueName);
+    else
+        UnLua::FLuaEnv::FindEnvChecked(L).GetNameRegistry()->Push(L, ShortName);
 
     return 1;
 }
@@ -1724,6 +1935,111 @@ int32 Class_NewIndex(lua_State *L)
     return 0;
 }
 
+/**
+ * Push the class metatable of an object/struct userdata or a bound Lua instance, whose properties are resolved and cached in it
+ */
+static bool PushClassMetatable(lua_State *L, int32 Index)
+{
+    if (!lua_getmetatable(L, Index))
+        return false;
+
+    if (lua_type(L, Index) == LUA_TTABLE)
+    {
+        // a bound instance, its metatable is the Lua module whose metatable is the class metatable
+        const bool bPushed = lua_getmetatable(L, -1) != 0;
+        lua_remove(L, bPushed ? -2 : -1);
+        return bPushed;
+    }
+    return true;
+}
+
+/**
+ * Get the instance of a UObject/struct for bulk property access, class metatables are excluded
+ */
+static void* GetPropertyContainer(lua_State *L, int32 Index)
+{
+    bool bTwoLvlPtr = false, bClassMetatable = false;
+    void *Userdata = GetUserdata(L, Index, &bTwoLvlPtr, &bClassMetatable);
+    if (!Userdata || bClassMetatable)
+        return nullptr;
+    return bTwoLvlPtr ? *((void**)Userdata) : Userdata;
+}
+
+/**
+ * Read multiple properties at once, e.g. 'local Health, Level = Object:GetProperties("Health", "Level")'.
+ * Names that are not properties get nil.
+ */
+int32 Class_GetProperties(lua_State *L)
+{
+    const int32 NumNames = lua_gettop(L) - 1;
+    if (NumNames < 1)
+        return 0;
+
+    void *Self = GetPropertyContainer(L, 1);
+    if (!Self || !PushClassMetatable(L, 1))
+    {
+        UE_LOG(LogUnLua, Warning, TEXT("%s: Invalid object!"), ANSI_TO_TCHAR(__FUNCTION__));
+        return 0;
+    }
+
+    const int32 MetatableIndex = lua_gettop(L);
+    luaL_checkstack(L, NumNames + LUA_MINSTACK, nullptr);      // GetField and Read push their temporaries above the results
+    for (int32 i = 2; i < MetatableIndex; ++i)
+    {
+        if (lua_type(L, i) == LUA_TSTRING && GetField(L, MetatableIndex, i) == LUA_TUSERDATA)
+        {
+            const TSharedPtr<UnLua::ITypeOps>& Property = *(TSharedPtr<UnLua::ITypeOps>*)UnLua::GetSmartPointer(L, -1);
+            if (Property.IsValid())
+            {
+                Property->Read(L, Self, false);
+                lua_remove(L, -2);
+                continue;
+            }
+        }
+        lua_settop(L, MetatableIndex + i - 2);
+        lua_pushnil(L);
+    }
+    return NumNames;
+}
+
+/**
+ * Write multiple properties at once, e.g. 'Object:SetProperties({ Health = 100, Level = 2 })'.
+ * Keys that are not properties are ignored.
+ */
+int32 Class_SetProperties(lua_State *L)
+{
+    void *Self = GetPropertyContainer(L, 1);
+    if (!Self || lua_type(L, 2) != LUA_TTABLE)
+    {
+        UE_LOG(LogUnLua, Warning, TEXT("%s: Invalid parameters!"), ANSI_TO_TCHAR(__FUNCTION__));
+        return 0;
+    }
+
+    lua_settop(L, 2);
+    if (!PushClassMetatable(L, 1))
+        return 0;
+
+    lua_pushnil(L);
+    while (lua_next(L, 2) != 0)             // key at 4, value at 5
+    {
+        if (lua_type(L, 4) == LUA_TSTRING && GetField(L, 3, 4) == LUA_TUSERDATA)
+        {
+            const TSharedPtr<UnLua::ITypeOps>& Property = *(TSharedPtr<UnLua::ITypeOps>*)UnLua::GetSmartPointer(L, -1);
+            if (Property.IsValid())
+            {
+#if ENABLE_TYPE_CHECK == 1
+                if (IsPropertyOwnerTypeValid(Property.Get(), Self))
+                    Property->Write(L, Self, 5);
+#else
+                Property->Write(L, Self, 5);
+#endif
+            }
+        }
+        lua_settop(L, 4);
+    }
+    return 0;
+}
+
 /**
  * Generic closure to call a UFunction
  */
@@ -1865,7 +2181,7 @@ int32 ScriptStruct_New(lua_State *L)
     }
 
     UScriptStruct *ScriptStruct = ClassDesc->AsScriptStruct();
-    void *Userdata = NewUserdataWithPadding(L, ClassDesc->GetSize(), TCHAR_TO_UTF8(*ClassDesc->GetName()), ClassDesc->GetUserdataPadding());
+    void *Userdata = NewUserdataWithPadding(L, ClassDesc);
     ScriptStruct->InitializeStruct(Userdata);
 
     return 1;
@@ -1922,7 +2238,7 @@ int32 ScriptStruct_CopyFrom(lua_State *L)
 	}
 	else
 	{
-		Userdata = NewUserdataWithPadding(L, ClassDesc->GetSize(), TCHAR_TO_UTF8(*ClassDesc->GetName()), ClassDesc->GetUserdataPadding());
+		Userdata = NewUserdataWithPadding(L, ClassDesc);
 		ScriptStruct->InitializeStruct(Userdata);
 	}
 	ScriptStruct->CopyScriptStruct(Src,Userdata);
@@ -1952,7 +2268,7 @@ int32 ScriptStruct_Copy(lua_State *L)
     }
     else
     {
-        Userdata = NewUserdataWithPadding(L, ClassDesc->GetSize(), TCHAR_TO_UTF8(*ClassDesc->GetName()), ClassDesc->GetUserdataPadding());
+        Userdata = NewUserdataWithPadding(L, ClassDesc);
         ScriptStruct->InitializeStruct(Userdata);
     }
     ScriptStruct->CopyScriptStruct(Userdata, Src);
@@ -18,6 +18,8 @@
 #include "UnLuaCompatibility.h"
 #include "lua.hpp"
 
+class FClassDesc;
+
 struct FScriptContainerDesc
 {
     FORCEINLINE int32 GetSize() const { return Size; }
@@ -36,6 +38,11 @@ private:
     const char *Name;
 };
 
+/**
+ * Whether Lua classes are created by the native 'Class' instead of the one in UnLua.lua, see UUnLuaSettings::bNativeClass
+ */
+UNLUA_API extern bool GLuaNativeClass;
+
 FString GetFullPathFromRelativePath(const FString& RelativePath);
 void SetTableForClass(lua_State *L, const char *Name);
 
@@ -43,6 +50,7 @@ void SetTableForClass(lua_State *L, const char *Name);
  * Set metatable for the userdata/table on the top of the stack
  */
 bool TryToSetMetatable(lua_State *L, const char *MetatableName, UObject* Object = nullptr);
+bool TryToSetMetatable(lua_State *L, FClassDesc *ClassDesc);
 
 /**
  * Functions to handle Lua userdata
@@ -56,6 +64,12 @@ UNLUA_API void* GetUserdata(lua_State *L, int32 Index, bool *OutTwoLvlPtr = null
 UNLUA_API void* GetUserdataFast(lua_State *L, int32 Index, bool *OutTwoLvlPtr = nullptr);
 UNLUA_API void* NewUserdataWithPadding(lua_State *L, int32 Size, const char *MetatableName, uint8 PaddingSize = 0);
 #define NewTypedUserdata(L, Type) NewUserdataWithPadding(L, sizeof(Type), #Type, CalcUserdataPadding<Type>())
+void* NewUserdataWithPadding(lua_State *L, FClassDesc *ClassDesc);
+
+namespace UnLua
+{
+    int32 PushPointer(lua_State *L, void *Value, const char *MetatableName, FClassDesc *ClassDesc, bool bAlwaysCreate = false);
+}
 UNLUA_API void* GetCppInstance(lua_State *L, int32 Index);
 UNLUA_API void* GetCppInstanceFast(lua_State *L, int32 Index);
 
@@ -139,6 +153,7 @@ int32 Global_LoadObject(lua_State *L);
 int32 Global_LoadClass(lua_State *L);
 int32 Global_NewObject(lua_State *L);
 UNLUA_API int32 Global_Print(lua_State *L);
+void RegisterNativeClass(lua_State *L);
 int32 Global_AddToClassWhiteSet(lua_State* L);
 int32 Global_RemoveFromClassWhiteSet(lua_State* L);
 
@@ -160,6 +175,8 @@ int32 Class_CallUFunction(lua_State *L);
 int32 Class_CallLatentFunction(lua_State *L);
 int32 Class_StaticClass(lua_State *L);
 int32 Class_Cast(lua_State* L);
+int32 Class_GetProperties(lua_State *L);
+int32 Class_SetProperties(lua_State *L);
 
 /**
  * Functions to handle UScriptStruct
@@ -0,0 +1,257 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+#include "LuaCpuProfiler.h"
+#include "HAL/RunnableThread.h"
+#include "Algo/Reverse.h"
+#include "LuaEnv.h"
+
+namespace UnLua
+{
+    static FCriticalSection HookLock;
+
+    static FString EscapeJSON(const FString& String)
+    {
+        return String.Replace(TEXT("\\"), TEXT("\\\\")).Replace(TEXT("\""), TEXT("\\\""));
+    }
+
+    FCpuProfiler::FCpuProfiler(FLuaEnv* Env)
+        : Env(Env)
+    {
+    }
+
+    FCpuProfiler::~FCpuProfiler()
+    {
+        Stop();
+    }
+
+    bool FCpuProfiler::Start(int32 InSampleRate)
+    {
+        if (IsRunning())
+            return true;
+
+        if (!FPlatformProcess::SupportsMultithreading())
+            return false;
+
+        Frames.Empty();
+        FrameIndices.Empty();
+        Stacks.Empty();
+        StackIndices.Empty();
+        StackCounts.Empty();
+        Samples.Empty();
+        NumLateSamples = 0;
+
+        InSampleRate = FMath::Max(InSampleRate, 1);
+        Interval = 1.0 / InSampleRate;
+        StartTime = FPlatformTime::Seconds();
+        Sampler = new FSampler(Env->GetMainState(), InSampleRate);
+        return true;
+    }
+
+    void FCpuProfiler::Stop()
+    {
+        if (!IsRunning())
+            return;
+
+        delete Sampler;
+        Sampler = nullptr;
+        CompareAndSetHook(Env->GetMainState(), {OnLuaCountEvent}, nullptr, 0, 0);
+    }
+
+    lua_Hook FCpuProfiler::GetSamplingHook()
+    {
+        return OnLuaCountEvent;
+    }
+
+    bool FCpuProfiler::CompareAndSetHook(lua_State* L, std::initializer_list<lua_Hook> Expected, lua_Hook Hook, int32 Mask, int32 Count)
+    {
+        FScopeLock Lock(&HookLock);
+        const lua_Hook Current = lua_gethook(L);
+        for (const lua_Hook Candidate : Expected)
+        {
+            if (Current == Candidate)
+            {
+                lua_sethook(L, Hook, Mask, Count);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void FCpuProfiler::OnLuaCountEvent(lua_State* L, lua_Debug* ar)
+    {
+        // check the time before the hook is cleared, the sampler arms it again right after
+        const auto Env = FLuaEnv::FindEnv(L);
+        const auto Profiler = Env ? Env->GetCpuProfiler().Get() : nullptr;
+        const bool bTimely = Profiler && Profiler->IsRunning() && Profiler->Sampler->IsTimely();
+
+        // the dead loop check may have replaced it in the meantime
+        CompareAndSetHook(L, {OnLuaCountEvent}, nullptr, 0, 0);
+        if (bTimely)
+            Profiler->Sample(L);
+        else if (Profiler && Profiler->IsRunning())
+            ++Profiler->NumLateSamples;
+    }
+
+    void FCpuProfiler::Sample(lua_State* L)
+    {
+        if (!IsRunning() || Samples.Num() >= MaxSamples)
+            return;
+
+        TArray<int32, TInlineAllocator<MaxDepth>> Stack;
+        lua_Debug ar;
+        for (int32 Level = 0; Level < MaxDepth && lua_getstack(L, Level, &ar); ++Level)
+        {
+            lua_getinfo(L, "Sn", &ar);
+            Stack.Add(FindOrAddFrame(ar));
+        }
+        if (Stack.Num() == 0)
+            return;
+
+        Algo::Reverse(Stack);
+        FString Key;
+        for (const int32 Frame : Stack)
+        {
+            Key.AppendInt(Frame);
+            Key.AppendChar(TEXT(','));
+        }
+
+        int32 StackIndex;
+        if (const int32* Found = StackIndices.Find(Key))
+        {
+            StackIndex = *Found;
+        }
+        else
+        {
+            StackIndex = Stacks.Emplace(Stack);
+            StackCounts.Add(0);
+            StackIndices.Add(Key, StackIndex);
+        }
+
+        StackCounts[StackIndex]++;
+        Samples.Add({FPlatformTime::Seconds(), StackIndex});
+    }
+
+    int32 FCpuProfiler::FindOrAddFrame(lua_Debug& ar)
+    {
+        // folded stacks are separated by ';'
+        const FString Name = ar.name ? UTF8_TO_TCHAR(ar.name) : TEXT("?");
+        const FString Frame = ar.what && FCStringAnsi::Strcmp(ar.what, "C") == 0
+                                  ? FString::Printf(TEXT("%s [C]"), *Name)
+                                  : FString::Printf(TEXT("%s (%s:%d)"), *Name, UTF8_TO_TCHAR(ar.short_src), ar.linedefined);
+        const FString Cleaned = Frame.Replace(TEXT(";"), TEXT(":"));
+        if (const int32* Index = FrameIndices.Find(Cleaned))
+            return *Index;
+
+        const int32 Index = Frames.Add(Cleaned);
+        FrameIndices.Add(Cleaned, Index);
+        return Index;
+    }
+
+    FString FCpuProfiler::ToFolded() const
+    {
+        FString Result;
+        for (int32 i = 0; i < Stacks.Num(); i++)
+        {
+            for (int32 j = 0; j < Stacks[i].Num(); j++)
+            {
+                if (j > 0)
+                    Result.AppendChar(TEXT(';'));
+                Result += Frames[Stacks[i][j]];
+            }
+            Result += FString::Printf(TEXT(" %d\n"), StackCounts[i]);
+        }
+        return Result;
+    }
+
+    FString FCpuProfiler::ToChromeTrace() const
+    {
+        FString Result = TEXT("{\"traceEvents\": [\n");
+        bool bFirst = true;
+        const auto AddEvent = [&](int32 Frame, const TCHAR* Phase, double Time)
+        {
+            Result += FString::Printf(TEXT("%s{\"name\": \"%s\", \"cat\": \"lua\", \"ph\": \"%s\", \"ts\": %.1f, \"pid\": 0, \"tid\": 0}"),
+                                      bFirst ? TEXT("") : TEXT(",\n"), *EscapeJSON(Frames[Frame]), Phase, (Time - StartTime) * 1000000);
+            bFirst = false;
+        };
+
+        // consecutive samples sharing the root part of their stacks are the same calls going on
+        TArray<int32> Open;
+        double Time = StartTime;
+        for (const auto& Sample : Samples)
+        {
+            const auto& Stack = Stacks[Sample.Stack];
+            int32 NumCommon = 0;
+            while (NumCommon < Open.Num() && NumCommon < Stack.Num() && Open[NumCommon] == Stack[NumCommon])
+                NumCommon++;
+
+            Time = Sample.Time;
+            for (int32 i = Open.Num() - 1; i >= NumCommon; i--)
+                AddEvent(Open[i], TEXT("E"), Time);
+            for (int32 i = NumCommon; i < Stack.Num(); i++)
+                AddEvent(Stack[i], TEXT("B"), Time);
+            Open = Stack;
+        }
+
+        for (int32 i = Open.Num() - 1; i >= 0; i--)
+            AddEvent(Open[i], TEXT("E"), Time + Interval);
+
+        Result += TEXT("\n]}\n");
+        return Result;
+    }
+
+    FCpuProfiler::FSampler::FSampler(lua_State* L, int32 SampleRate)
+        : L(L),
+          Interval(1.0f / SampleRate),
+          MaxDelayCycles((uint64)(1.0 / SampleRate / FPlatformTime::GetSecondsPerCycle64())),
+          ArmedCycles(0),
+          bRunning(true)
+    {
+        Thread = FRunnableThread::Create(this, TEXT("LuaCpuProfiler"), 0, TPri_AboveNormal);
+    }
+
+    FCpuProfiler::FSampler::~FSampler()
+    {
+        Thread->Kill(true);
+        delete Thread;
+    }
+
+    uint32 FCpuProfiler::FSampler::Run()
+    {
+        while (bRunning)
+        {
+            FPlatformProcess::Sleep(Interval);
+
+            // same as FDeadLoopCheck, lua_sethook is safe to call from another thread; never replace someone else's hook,
+            // nor re-arm a pending one, so the armed time stays the one the hook is late against
+            FScopeLock Lock(&HookLock);
+            if (lua_gethook(L) == nullptr)
+            {
+                ArmedCycles = FPlatformTime::Cycles64();
+                lua_sethook(L, OnLuaCountEvent, LUA_MASKCOUNT, 1);
+            }
+        }
+        return 0;
+    }
+
+    bool FCpuProfiler::FSampler::IsTimely() const
+    {
+        return FPlatformTime::Cycles64() - ArmedCycles.load() <= MaxDelayCycles;
+    }
+
+    void FCpuProfiler::FSampler::Stop()
+    {
+        bRunning = false;
+    }
+}
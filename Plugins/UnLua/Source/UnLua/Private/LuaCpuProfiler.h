@@ -0,0 +1,122 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "lua.hpp"
+#include <atomic>
+
+namespace UnLua
+{
+    class FLuaEnv;
+
+    /**
+     * Sampling profiler of Lua code.
+     * A timer thread arms a one-shot count hook on the main Lua thread at the sample rate, and the hook records the
+     * Lua call stack the next time an instruction runs, so only time spent in Lua is sampled. A hook armed while Lua
+     * was idle fires at the next entry into Lua, such late samples are dropped. Stacks are kept as folded stacks for
+     * flamegraphs and as a timeline for Chrome trace. Coroutines have hooks of their own and aren't sampled.
+     */
+    class UNLUA_API FCpuProfiler
+    {
+    public:
+        static constexpr int32 DefaultSampleRate = 1000;    // samples per second
+        static constexpr int32 MaxDepth = 64;
+        static constexpr int32 MaxSamples = 1000000;
+
+        explicit FCpuProfiler(FLuaEnv* Env);
+
+        ~FCpuProfiler();
+
+        /** @return - false if the platform can't run the timer thread */
+        bool Start(int32 InSampleRate = DefaultSampleRate);
+
+        void Stop();
+
+        FORCEINLINE bool IsRunning() const { return Sampler != nullptr; }
+
+        FORCEINLINE int32 GetNumSamples() const { return Samples.Num(); }
+
+        /** samples dropped because the hook fired more than an interval after it was armed */
+        FORCEINLINE int32 GetNumLateSamples() const { return NumLateSamples; }
+
+        /** one line per distinct stack, root first, with the number of samples, as consumed by flamegraph.pl */
+        FString ToFolded() const;
+
+        /** begin/end events of every Lua frame in the Chrome trace event format */
+        FString ToChromeTrace() const;
+
+        /** the hook armed by the profiler, which other users of hooks may override */
+        static lua_Hook GetSamplingHook();
+
+        /**
+         * Set the hook of a Lua state only if the current one is expected. Hooks set from other threads and the
+         * clearing of the sampling hook go through here, so they never overwrite the dead loop check.
+         *
+         * @param Expected - hooks that may be replaced, nullptr included if it's in the list
+         * @return - true if the hook was set
+         */
+        static bool CompareAndSetHook(lua_State* L, std::initializer_list<lua_Hook> Expected, lua_Hook Hook, int32 Mask, int32 Count);
+
+    private:
+        class FSampler final : public FRunnable
+        {
+        public:
+            FSampler(lua_State* L, int32 SampleRate);
+
+            virtual ~FSampler() override;
+
+            virtual uint32 Run() override;
+
+            virtual void Stop() override;
+
+            /** whether the armed hook fires within an interval */
+            bool IsTimely() const;
+
+        private:
+            lua_State* L;
+            float Interval;
+            uint64 MaxDelayCycles;
+            std::atomic<uint64> ArmedCycles;
+            FThreadSafeBool bRunning;
+            FRunnableThread* Thread;
+        };
+
+        struct FSample
+        {
+            double Time;
+            int32 Stack;
+        };
+
+        static void OnLuaCountEvent(lua_State* L, lua_Debug* ar);
+
+        void Sample(lua_State* L);
+
+        int32 FindOrAddFrame(lua_Debug& ar);
+
+        FLuaEnv* Env;
+        FSampler* Sampler = nullptr;
+        int32 NumLateSamples = 0;
+        double StartTime = 0;
+        double Interval = 0;
+        TArray<FString> Frames;
+        TMap<FString, int32> FrameIndices;
+        TArray<TArray<int32>> Stacks;   // root first
+        TMap<FString, int32> StackIndices;
+        TArray<int32> StackCounts;
+        TArray<FSample> Samples;
+    };
+}
@@ -16,6 +16,7 @@
 #include "lua.hpp"
 #include "HAL/RunnableThread.h"
 #include "UnLuaModule.h"
+#include "LuaCpuProfiler.h"
 
 namespace UnLua
 {
@@ -102,10 +103,9 @@ namespace UnLua
 
     void FDeadLoopCheck::FGuard::SetTimeout()
     {
+        // a pending sampling hook is overridden, under the same lock the profiler arms and clears it
         const auto L = Owner->Env->GetMainState();
-        const auto Hook = lua_gethook(L);
-        if (Hook == nullptr)
-            lua_sethook(L, OnLuaLineEvent, LUA_MASKLINE, 0);
+        FCpuProfiler::CompareAndSetHook(L, {nullptr, FCpuProfiler::GetSamplingHook()}, OnLuaLineEvent, LUA_MASKLINE, 0);
     }
 
     void FDeadLoopCheck::FGuard::OnLuaLineEvent(lua_State* L, lua_Debug* ar)
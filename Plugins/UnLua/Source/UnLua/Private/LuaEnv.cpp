@@ -20,10 +20,6 @@
 #include "LowLevel.h"
 #include "Registries/ObjectRegistry.h"
 #include "Registries/ClassRegistry.h"
-extern "C"
-{
-    #include "lstate.h"
-}
 #include "LuaCore.h"
 #include "LuaDynamicBinding.h"
 #include "lua.hpp"
@@ -44,7 +40,11 @@ namespace UnLua
     {
         RegisterDelegates();
 
-        L = lua_newstate(GetLuaAllocator(), nullptr);
+        if (GLuaPooledAllocator)
+            Allocator = MakeUnique<FLuaAllocator>();
+
+        L = lua_newstate(GetLuaAllocator(), Allocator.Get());
+        *(FLuaEnv**)lua_getextraspace(L) = this;
         AllEnvs.Add(L, this);
 
         luaL_openlibs(L);
@@ -63,7 +63,10 @@ namespace UnLua
         DelegateRegistry = MakeShared<FDelegateRegistry>(this);
         ContainerRegistry = MakeShared<FContainerRegistry>(this);
         EnumRegistry = MakeShared<FEnumRegistry>(this);
+        NameRegistry = MakeShared<FNameRegistry>(this);
         DeadLoopCheck = MakeShared<FDeadLoopCheck>(this);
+        AllocProfiler = MakeShared<FAllocProfiler>(this);
+        CpuProfiler = MakeShared<FCpuProfiler>(this);
 
         AutoObjectReference.SetName("UnLua_AutoReference");
         ManualObjectReference.SetName("UnLua_ManualReference");
@@ -83,6 +86,8 @@ namespace UnLua
         lua_register(L, "LoadClass", Global_LoadClass);
         lua_register(L, "NewObject", Global_NewObject);
         lua_register(L, "UEPrint", Global_Print);
+        if (GLuaNativeClass)
+            RegisterNativeClass(L);
 
         if (FUnLuaDelegates::ConfigureLuaGC.IsBound())
         {
@@ -99,6 +104,9 @@ namespace UnLua
 #endif
         }
 
+        GCScheduler = MakeShared<FGCScheduler>(this);
+        GCScheduler->SetBudget(GLuaGCBudget);
+
         lua_register(L, "print", Global_Print);
 
         // add new package path
@@ -137,6 +145,8 @@ namespace UnLua
 
     FLuaEnv::~FLuaEnv()
     {
+        AllocProfiler->Stop();
+        CpuProfiler->Stop();
         lua_close(L);
         AllEnvs.Remove(L);
 
@@ -155,20 +165,6 @@ namespace UnLua
         FWorldDelegates::OnWorldTickStart.Remove(OnWorldTickStartHandle);
     }
 
-    FLuaEnv* FLuaEnv::FindEnv(const lua_State* L)
-    {
-        if (!L)
-            return nullptr;
-
-        const auto MainThread = G(L)->mainthread;
-        return AllEnvs.FindRef(MainThread);
-    }
-
-    FLuaEnv& FLuaEnv::FindEnvChecked(const lua_State* L)
-    {
-        return *AllEnvs.FindChecked(G(L)->mainthread);
-    }
-
     const FString& FLuaEnv::GetName()
     {
         return Name;
@@ -181,11 +177,21 @@ namespace UnLua
 
     void FLuaEnv::NotifyUObjectDeleted(const UObjectBase* ObjectBase, int32 Index)
     {
+        if (!ExposedObjects.Accept(Index))
+        {
+            INC_DWORD_STAT(STAT_UnLua_DeleteNotify_Rejected);
+            return;
+        }
+        INC_DWORD_STAT(STAT_UnLua_DeleteNotify_Accepted);
+        ExposedObjects.Remove(Index);
+
         UObject* Object = (UObject*)ObjectBase;
+        BindDescriptors.Remove((UClass*)Object);
         FunctionRegistry->NotifyUObjectDeleted(Object);
         if (Manager)
             Manager->NotifyUObjectDeleted(Object);
         ObjectRegistry->NotifyUObjectDeleted(Object);
+        DelegateRegistry->NotifyUObjectDeleted(Object);
 
         if (CandidateInputComponents.Num() <= 0)
             return;
@@ -215,6 +221,7 @@ namespace UnLua
             return false;
 
         CandidateInputComponents.AddUnique((UInputComponent*)Object);
+        MarkExposed(Object);
         if (OnWorldTickStartHandle.IsValid())
             FWorldDelegates::OnWorldTickStart.Remove(OnWorldTickStartHandle);
         OnWorldTickStartHandle = FWorldDelegates::OnWorldTickStart.AddRaw(this, &FLuaEnv::OnWorldTickStart);
@@ -239,31 +246,80 @@ namespace UnLua
         FWorldDelegates::OnWorldTickStart.Remove(OnWorldTickStartHandle);
     }
 
-    bool FLuaEnv::TryBind(UObject* Object)
+    static bool IsInWidgetArchetype(const UObject* Object)
     {
-        UClass* Class = Object->GetClass();
-        if (Class->IsChildOf<UPackage>() || Class->IsChildOf<UClass>() || Class->HasAnyClassFlags(CLASS_NewerVersionExists))
+        static const FName WidgetTreeName = FName("WidgetTree");
+        static const FName WidgetArchetypeName = FName("WidgetArchetype");
+
+        // both patterns below need an outer with one of these names, so skip building the full name in common cases
+        bool bHasWidgetOuter = false;
+        for (const UObject* Outer = Object->GetOuter(); Outer && Outer != GWorld; Outer = Outer->GetOuter())
         {
-            // filter out UPackage and UClass and recompiled objects
+            const FName OuterName = Outer->GetFName();
+            if (OuterName == WidgetTreeName || OuterName == WidgetArchetypeName)
+            {
+                bHasWidgetOuter = true;
+                break;
+            }
+        }
+        if (!bHasWidgetOuter)
             return false;
+
+        FString ObjectName;
+        Object->GetFullName(GWorld, ObjectName);
+        if (ObjectName.Contains(".WidgetArchetype:") || ObjectName.Contains(":WidgetTree."))
+        {
+            UE_LOG(LogUnLua, Warning, TEXT("Filter UObject of %s in WidgetArchetype"), *ObjectName);
+            return true;
         }
+        return false;
+    }
 
-        static UClass* InterfaceClass = UUnLuaInterface::StaticClass();
-        const bool bImplUnluaInterface = Class->ImplementsInterface(InterfaceClass);
-        
+    bool FLuaEnv::TryBind(UObject* Object)
+    {
+        UClass* Class = Object->GetClass();
         if (!IsInGameThread() || Object->HasAnyInternalFlags(AsyncObjectFlags))
         {
+            if (Class->IsChildOf<UPackage>() || Class->IsChildOf<UClass>() || Class->HasAnyClassFlags(CLASS_NewerVersionExists))
+                return false;
+
             // avoid adding too many objects, affecting performance.
-            if (bImplUnluaInterface || (!bImplUnluaInterface && GLuaDynamicBinding.IsValid(Class)))
+            static UClass* InterfaceClass = UUnLuaInterface::StaticClass();
+            if (Class->ImplementsInterface(InterfaceClass) || GLuaDynamicBinding.IsValid(Class))
             {
                 // all bind operation should be in game thread, include dynamic bind
-                FScopeLock Lock(&CandidatesLock);
-                Candidates.AddUnique(Object);
+                Candidates.Enqueue(Object);
+            }
+            return false;
+        }
+
+        if (Class->HasAnyClassFlags(CLASS_NewerVersionExists))
+        {
+            // filter out recompiled objects
+            return false;
+        }
+
+        FBindDescriptor NewDescriptor;
+        const FBindDescriptor* Descriptor = bBindCacheEnabled ? BindDescriptors.Find(Class) : nullptr;
+        if (!Descriptor)
+        {
+            if (!ResolveBindDescriptor(Object, NewDescriptor))
                 return false;
+            if (bBindCacheEnabled)
+            {
+                Descriptor = &BindDescriptors.Add(Class, MoveTemp(NewDescriptor));
+                MarkExposed(Class);
+            }
+            else
+            {
+                Descriptor = &NewDescriptor;
             }
         }
 
-        if (!bImplUnluaInterface)
+        if (Descriptor->bFiltered)
+            return false;
+
+        if (!Descriptor->bImplUnluaInterface)
         {
             // dynamic binding
             if (!GLuaDynamicBinding.IsValid(Class))
@@ -282,20 +338,53 @@ namespace UnLua
             return false;
         }
 
-        if (GWorld)
+        if (GWorld && IsInWidgetArchetype(Object))
+            return false;
+
+        const bool bIsCDO = Object->HasAnyFlags(RF_ClassDefaultObject | RF_ArchetypeObject);
+        if ((bIsCDO && (Object->GetFlags() & RF_NeedInitialization)) || Descriptor->ModuleName.IsEmpty())
+            return false;
+
+        // copy it, binding may create objects and grow the descriptor map
+        const FString ModuleName = Descriptor->ModuleName;
+
+#if !UE_BUILD_SHIPPING
+        if (GLuaDynamicBinding.IsValid(Class) && GLuaDynamicBinding.ModuleName != ModuleName)
         {
-            FString ObjectName;
-            Object->GetFullName(GWorld, ObjectName);
-            if (ObjectName.Contains(".WidgetArchetype:") || ObjectName.Contains(":WidgetTree."))
-            {
-                UE_LOG(LogUnLua, Warning, TEXT("Filter UObject of %s in WidgetArchetype"), *ObjectName);
-                return false;
-            }
+            UE_LOG(LogUnLua, Warning, TEXT("Dynamic binding '%s' ignored as it conflicts static binding '%s'."), *GLuaDynamicBinding.ModuleName, *ModuleName);
+        }
+#endif
+
+        return GetManager()->Bind(Object, *ModuleName, GLuaDynamicBinding.InitializerTableRef);
+    }
+
+    bool FLuaEnv::ResolveBindDescriptor(UObject* Object, FBindDescriptor& Descriptor) const
+    {
+        UClass* Class = Object->GetClass();
+        if (Class->IsChildOf<UPackage>() || Class->IsChildOf<UClass>())
+        {
+            // filter out UPackage and UClass
+            Descriptor.bFiltered = true;
+            return true;
+        }
+
+        static UClass* InterfaceClass = UUnLuaInterface::StaticClass();
+        Descriptor.bImplUnluaInterface = Class->ImplementsInterface(InterfaceClass);
+        if (!Descriptor.bImplUnluaInterface)
+            return true;
+
+        if (Class->GetName().Contains(TEXT("SKEL_")))
+        {
+            Descriptor.bFiltered = true;
+            return true;
         }
 
         UFunction* Func = Class->FindFunctionByName(FName("GetModuleName")); // find UFunction 'GetModuleName'. hard coded!!!
         if (!Func)
-            return false;
+        {
+            Descriptor.bFiltered = true;
+            return true;
+        }
 
         // native func may not be bind in level bp
         if (!Func->GetNativeFunc())
@@ -303,29 +392,27 @@ namespace UnLua
             Func->Bind();
             if (!Func->GetNativeFunc())
             {
-                UE_LOG(LogUnLua, Warning, TEXT("TryToBindLua: bind native function failed for GetModuleName in object %s"), *Object->GetName());
-                return false;
+                UE_LOG(LogUnLua, Warning, TEXT("TryToBindLua: bind native function failed for GetModuleName in class %s"), *Class->GetName());
+                Descriptor.bFiltered = true;
+                return true;
             }
         }
 
+        // module name can't be resolved until the CDO finished initialization, don't cache anything yet
         const bool bIsCDO = Object->HasAnyFlags(RF_ClassDefaultObject | RF_ArchetypeObject);
-        if ((bIsCDO && (Object->GetFlags() & RF_NeedInitialization)) || Class->GetName().Contains(TEXT("SKEL_")))
+        if (bIsCDO && (Object->GetFlags() & RF_NeedInitialization))
             return false;
 
-        FString ModuleName;
         UObject* CDO = bIsCDO ? Object : Class->GetDefaultObject();
-        CDO->ProcessEvent(Func, &ModuleName);
-        if (ModuleName.IsEmpty())
-            return false;
-
-#if !UE_BUILD_SHIPPING
-        if (GLuaDynamicBinding.IsValid(Class) && GLuaDynamicBinding.ModuleName != ModuleName)
-        {
-            UE_LOG(LogUnLua, Warning, TEXT("Dynamic binding '%s' ignored as it conflicts static binding '%s'."), *GLuaDynamicBinding.ModuleName, *ModuleName);
-        }
-#endif
+        CDO->ProcessEvent(Func, &Descriptor.ModuleName);
+        return true;
+    }
 
-        return GetManager()->Bind(Object, *ModuleName, GLuaDynamicBinding.InitializerTableRef);
+    void FLuaEnv::SetBindCacheEnabled(bool bEnabled)
+    {
+        bBindCacheEnabled = bEnabled;
+        if (!bEnabled)
+            BindDescriptors.Empty();
     }
 
     bool FLuaEnv::DoString(const FString& Chunk, const FString& ChunkName)
@@ -333,6 +420,7 @@ namespace UnLua
         // TODO: env support
         // TODO: return value support
         const auto Guard = GetDeadLoopCheck()->MakeGuard();
+        const FParamArena::FScope ParamScope(ParamArena);
         bool bOk = !luaL_dostring(L, TCHAR_TO_UTF8(*Chunk));
         if (bOk)
             return bOk;
@@ -383,6 +471,7 @@ namespace UnLua
             return;
 
         lua_State* Thread = *ThreadPtr;
+        const FParamArena::FScope ParamScope(ParamArena);
 #if 504 == LUA_VERSION_NUM
         int NResults = 0;
         int32 Status = lua_resume(Thread, L, 0, &NResults);
@@ -440,6 +529,8 @@ namespace UnLua
 
     lua_Alloc FLuaEnv::GetLuaAllocator() const
     {
+        if (Allocator)
+            return FLuaAllocator::Alloc;
         return DefaultLuaAllocator;
     }
 
@@ -551,53 +642,40 @@ namespace UnLua
 
     void FLuaEnv::OnAsyncLoadingFlushUpdate()
     {
-        TArray<FWeakObjectPtr> CandidatesTemp;
-        TArray<int> CandidatesRemovedIndexes;
+        FWeakObjectPtr Candidate;
+        while (Candidates.Dequeue(Candidate))
+            DeferredCandidates.Add(Candidate);
+
+        if (DeferredCandidates.Num() == 0)
+            return;
 
         TArray<UObject*> LocalCandidates;
+        int32 NumDeferred = 0;
+        for (const FWeakObjectPtr& ObjectPtr : DeferredCandidates)
         {
-            {
-                FScopeLock Lock(&CandidatesLock);
-                CandidatesTemp.Append(Candidates);    
-            }
+            UObject* Object = ObjectPtr.Get();
+            if (!Object)
+                continue; // discard invalid objects
 
-
-            for (int32 i = CandidatesTemp.Num() - 1; i >= 0; --i)
+            if (Object->HasAnyFlags(RF_NeedPostLoad)
+                || Object->HasAnyInternalFlags(AsyncObjectFlags)
+                || Object->GetClass()->HasAnyInternalFlags(AsyncObjectFlags))
             {
-                FWeakObjectPtr ObjectPtr = CandidatesTemp[i];
-                if (!ObjectPtr.IsValid())
-                {
-                    // discard invalid objects
-                    CandidatesRemovedIndexes.Add(i);
-                    continue;
-                }
-
-                UObject* Object = ObjectPtr.Get();
-                if (Object->HasAnyFlags(RF_NeedPostLoad)
-                    || Object->HasAnyInternalFlags(AsyncObjectFlags)
-                    || Object->GetClass()->HasAnyInternalFlags(AsyncObjectFlags))
-                {
-                    // delay bind on next update 
-                    continue;
-                }
-
-                LocalCandidates.Add(Object);
-                CandidatesRemovedIndexes.Add(i);
+                // delay bind on next update
+                DeferredCandidates[NumDeferred++] = ObjectPtr;
+                continue;
             }
-        }
 
-        {
-            FScopeLock Lock(&CandidatesLock);
-            for(int32 j = 0; j < CandidatesRemovedIndexes.Num();++j)
-            {
-                Candidates.RemoveAt(CandidatesRemovedIndexes[j]);
-            }
+            LocalCandidates.Add(Object);
         }
+        DeferredCandidates.SetNum(NumDeferred, false);
 
-        for (int32 i = 0; i < LocalCandidates.Num(); ++i)
+        // a candidate may be queued more than once, bind it only the first time
+        for (int32 i = LocalCandidates.Num() - 1; i >= 0; --i)
         {
             UObject* Object = LocalCandidates[i];
-            TryBind(Object);
+            if (!ObjectRegistry->IsBound(Object))
+                TryBind(Object);
         }
     }
 
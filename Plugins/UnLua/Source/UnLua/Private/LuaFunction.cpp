@@ -38,7 +38,12 @@ static UClass* MakeOrphanedClass(const UClass* Class)
 DEFINE_FUNCTION(ULuaFunction::execCallLua)
 {
     const auto LuaFunction = Cast<ULuaFunction>(Stack.CurrentNativeFunction);
-    const auto Env = IUnLuaModule::Get().GetEnv(Context);
+    // hold the env until the call returns, the Lua code may tear it down, e.g. ending PIE
+    TSharedPtr<UnLua::FLuaEnv> Env;
+    if (const auto BoundEnv = UnLua::FObjectRegistry::FindBoundEnv(Context)) // the env Context is bound to, no need to locate again
+        Env = BoundEnv->AsShared();
+    else
+        Env = IUnLuaModule::Get().GetEnv(Context);
     if (!Env)
     {
         // PIE 结束时可能已经没有Lua环境了
@@ -0,0 +1,155 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+#include "LuaGCScheduler.h"
+#include "LuaEnv.h"
+#include "UnLuaPrivate.h"
+#include "Misc/CoreDelegates.h"
+#include "UObject/UObjectGlobals.h"
+
+int32 GLuaGCBudget = 0;
+
+namespace UnLua
+{
+    FGCScheduler::FGCScheduler(FLuaEnv* Env)
+        : Env(Env)
+    {
+        OnEndFrameHandle = FCoreDelegates::OnEndFrame.AddRaw(this, &FGCScheduler::Tick);
+        PreGarbageCollectHandle = FCoreUObjectDelegates::GetPreGarbageCollectDelegate().AddRaw(this, &FGCScheduler::OnPreGarbageCollect);
+    }
+
+    FGCScheduler::~FGCScheduler()
+    {
+        FCoreDelegates::OnEndFrame.Remove(OnEndFrameHandle);
+        FCoreUObjectDelegates::GetPreGarbageCollectDelegate().Remove(PreGarbageCollectHandle);
+    }
+
+    void FGCScheduler::SetBudget(int32 InBudget)
+    {
+        InBudget = FMath::Max(InBudget, 0);
+        if ((InBudget > 0) == IsEnabled())
+        {
+            Budget = InBudget;
+            return;
+        }
+
+        lua_State* L = Env->GetMainState();
+        Budget = InBudget;
+        if (Budget > 0)
+        {
+            // zero arguments keep the parameters, e.g. those set by FUnLuaDelegates::ConfigureLuaGC, so only the mode is saved
+            bWasRunning = lua_gc(L, LUA_GCISRUNNING, 0) != 0;
+#if 504 == LUA_VERSION_NUM
+            SavedMode = lua_gc(L, LUA_GCINC, 0, 0, 0);
+#endif
+            lua_gc(L, LUA_GCSTOP, 0);
+            LastCount = lua_gc(L, LUA_GCCOUNT, 0);
+            Threshold = LastCount * Pause / 100;
+            bInCycle = false;
+        }
+        else
+        {
+#if 504 == LUA_VERSION_NUM
+            if (SavedMode == LUA_GCGEN)
+                lua_gc(L, LUA_GCGEN, 0, 0);
+#endif
+            if (bWasRunning)
+                lua_gc(L, LUA_GCRESTART, 0);
+            NumDrainCycles = 0;
+            LastTickTime = 0;
+        }
+    }
+
+    bool FGCScheduler::RequestDrain()
+    {
+        if (!IsEnabled())
+            return false;
+
+        // the cycle in progress may have already marked part of the garbage as alive
+        NumDrainCycles = bInCycle ? 3 : 2;
+        return true;
+    }
+
+    void FGCScheduler::Tick()
+    {
+        if (!IsEnabled())
+            return;
+
+        SCOPE_CYCLE_COUNTER(STAT_UnLua_GC);
+
+        lua_State* L = Env->GetMainState();
+        const double StartTime = FPlatformTime::Seconds();
+        const int32 Count = lua_gc(L, LUA_GCCOUNT, 0);
+        const int32 Allocated = FMath::Max(Count - LastCount, 0);
+        if (!bInCycle && !IsDraining() && Count < Threshold)
+        {
+            LastCount = Count;
+            LastTickTime = 0;
+            return;
+        }
+
+        // falling behind the allocations, take more time before memory runs away
+        bInCycle = true;
+        const int32 FrameBudget = Count > Threshold * 2 ? Budget * CatchUpFactor : Budget;
+        const double EndTime = StartTime + FrameBudget / 1000000.0;
+
+        int32 NumSteps = 0;
+        double Now;
+        do
+        {
+            ++NumSteps;
+            INC_DWORD_STAT(STAT_UnLua_GC_Steps);
+            if (lua_gc(L, LUA_GCSTEP, StepSize))
+            {
+                OnCycleFinished();
+                if (!bInCycle)
+                    break;
+            }
+            Now = FPlatformTime::Seconds();
+        } while (Now < EndTime);
+        Now = FPlatformTime::Seconds();
+
+        // a single step took the whole budget, make steps smaller; work done didn't keep up with the allocations, make them bigger
+        if (NumSteps == 1 && Now > EndTime)
+            StepSize = FMath::Max(StepSize / 2, MinStepSize);
+        else if (bInCycle && NumSteps * StepSize < Allocated)
+            StepSize = FMath::Min(StepSize * 2, MaxStepSize);
+
+        LastCount = lua_gc(L, LUA_GCCOUNT, 0);
+        LastTickTime = Now - StartTime;
+    }
+
+    void FGCScheduler::OnPreGarbageCollect()
+    {
+        // e.g. the GC of a level transition runs in the same frame as the world cleanup which requested the drain,
+        // the old world's objects are still referenced by Lua until their userdata are collected
+        if (!IsDraining())
+            return;
+
+        SCOPE_CYCLE_COUNTER(STAT_UnLua_GC);
+        Env->GC();
+        NumDrainCycles = 0;
+        bInCycle = false;
+        LastCount = lua_gc(Env->GetMainState(), LUA_GCCOUNT, 0);
+        Threshold = LastCount * Pause / 100;
+    }
+
+    void FGCScheduler::OnCycleFinished()
+    {
+        Threshold = lua_gc(Env->GetMainState(), LUA_GCCOUNT, 0) * Pause / 100;
+        if (NumDrainCycles > 0)
+            --NumDrainCycles;
+        bInCycle = NumDrainCycles > 0;
+    }
+}
@@ -0,0 +1,91 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Microseconds of Lua GC work per frame for new envs, 0 leaves collection to Lua's automatic GC, see UUnLuaSettings::GCBudgetPerFrame
+ */
+UNLUA_API extern int32 GLuaGCBudget;
+
+namespace UnLua
+{
+    class FLuaEnv;
+
+    /**
+     * Spreads Lua garbage collection over frames.
+     * With a budget, the automatic GC is stopped and Lua is switched to incremental mode, then incremental steps run
+     * at the end of every frame until the budget is spent. The step size follows the allocation rate, and a new cycle
+     * only starts once memory has grown by the pause ratio since the last one, like Lua's own pacing.
+     * Without a budget, Lua collects on its own again, in the mode and running state saved when the budget was set.
+     */
+    class UNLUA_API FGCScheduler
+    {
+    public:
+        static constexpr int32 Pause = 200;             // percent of memory after a cycle to start the next one
+        static constexpr int32 MinStepSize = 1;         // in KB
+        static constexpr int32 MaxStepSize = 4096;      // in KB
+        static constexpr int32 CatchUpFactor = 4;       // budget multiplier when memory has grown over twice the threshold
+
+        explicit FGCScheduler(FLuaEnv* Env);
+
+        ~FGCScheduler();
+
+        void SetBudget(int32 InBudget);
+
+        FORCEINLINE int32 GetBudget() const { return Budget; }
+
+        FORCEINLINE bool IsEnabled() const { return Budget > 0; }
+
+        /**
+         * Collect all garbage over the following frames, within budget. Two cycles are run so that objects
+         * resurrected by finalizers are collected too, like FLuaEnv::GC. A drain still pending when UE GC
+         * starts is finished at once, so UObjects only referenced by collected Lua objects go in that GC.
+         *
+         * @return - false if the scheduler is disabled
+         */
+        bool RequestDrain();
+
+        FORCEINLINE bool IsDraining() const { return NumDrainCycles > 0; }
+
+        /** run incremental steps within budget, called at the end of every frame */
+        void Tick();
+
+        /** GC time of the last tick, in seconds */
+        FORCEINLINE double GetLastTickTime() const { return LastTickTime; }
+
+        /** in KB */
+        FORCEINLINE int32 GetStepSize() const { return StepSize; }
+
+    private:
+        void OnCycleFinished();
+
+        void OnPreGarbageCollect();
+
+        FLuaEnv* Env;
+        FDelegateHandle OnEndFrameHandle;
+        FDelegateHandle PreGarbageCollectHandle;
+        int32 Budget = 0;
+        int32 StepSize = 16;
+        int32 LastCount = 0;
+        int32 Threshold = 0;
+        int32 NumDrainCycles = 0;
+        bool bInCycle = false;
+        bool bWasRunning = true;        // state of the automatic GC before the budget was set
+        int32 SavedMode = 0;            // GC mode before the budget was set, LUA_GCGEN or LUA_GCINC
+        double LastTickTime = 0;
+    };
+}
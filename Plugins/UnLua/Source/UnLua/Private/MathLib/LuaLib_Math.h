@@ -299,14 +299,25 @@ namespace UnLua
     };
 
     /**
-     * Helper to get result address for += / -= / *= / /=, partial specialization
+     * Helper to get result address for += / -= / *= / /=, partial specialization.
+     * An optional output parameter, e.g. 'A:Add(B, Out)', receives the result instead of A, so temporaries can be reused without allocating
      */
     template <typename T>
     struct TResultHelper<T, true>
     {
         static T* GetResult(lua_State *L, T *A)
         {
-            return A;
+            if (lua_gettop(L) < 3)
+            {
+                return A;
+            }
+
+            uint64 Type = GetTypeHash(L, 3);
+            if (!Type || Type != GetTypeHash(L, 1))
+            {
+                return nullptr;
+            }
+            return (T*)GetCppInstanceFast(L, 3);
         }
     };
 
@@ -322,7 +333,7 @@ namespace UnLua
         static int32 Calculate(lua_State *L)
         {
             int32 NumParams = lua_gettop(L);
-            if (NumParams != 2)
+            if (NumParams != 2 && (!bAssignment || NumParams != 3))
             {
                 UE_LOG(LogUnLua, Log, TEXT("Invalid parameters!"));
                 return 0;
@@ -343,6 +354,12 @@ namespace UnLua
             }
 
             T *Result = TResultHelper<T, bAssignment>::GetResult(L, A);
+            if (!Result)
+            {
+                UE_LOG(LogUnLua, Log, TEXT("Invalid output parameter!"));
+                return 0;
+            }
+
             switch (ParamType)
             {
             case LUA_TUSERDATA:
@@ -365,6 +382,12 @@ namespace UnLua
                 }
                 break;
             }
+
+            if (bAssignment && NumParams == 3)
+            {
+                lua_pushvalue(L, 3);
+                return 1;
+            }
             return bAssignment ? 0 : 1;
         }
     };
@@ -0,0 +1,78 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/UObjectArray.h"
+
+namespace UnLua
+{
+    /**
+     * Conservative set of GUObjectArray indices, used to reject delete notifications of objects its owner never saw.
+     * False positives only cost the owner a lookup, so bits of objects deleted unnoticed may linger.
+     */
+    class FObjectIndexFilter
+    {
+    public:
+        FORCEINLINE void Add(const UObjectBase* Object) { Add(GUObjectArray.ObjectToIndex(Object)); }
+
+        void Add(int32 Index)
+        {
+            if (Index >= Bits.Num())
+                Bits.Add(false, FMath::RoundUpToPowerOfTwo(Index + 1) - Bits.Num());
+            Bits[Index] = true;
+        }
+
+        FORCEINLINE void Remove(int32 Index)
+        {
+            if (Index < Bits.Num())
+                Bits[Index] = false;
+        }
+
+        FORCEINLINE bool Contains(int32 Index) const { return Index < Bits.Num() && Bits[Index]; }
+
+        /** Test a delete notification and count the result */
+        FORCEINLINE bool Accept(int32 Index)
+        {
+            if (Contains(Index))
+            {
+                ++NumAccepted;
+                return true;
+            }
+            ++NumRejected;
+            return false;
+        }
+
+        void Reset()
+        {
+            Bits.Empty();
+        }
+
+        FORCEINLINE uint64 GetNumAccepted() const { return NumAccepted; }
+
+        FORCEINLINE uint64 GetNumRejected() const { return NumRejected; }
+
+        double GetRejectRate() const
+        {
+            const uint64 Total = NumAccepted + NumRejected;
+            return Total > 0 ? (double)NumRejected / Total : 0.0;
+        }
+
+    private:
+        TBitArray<> Bits;
+        uint64 NumAccepted = 0;
+        uint64 NumRejected = 0;
+    };
+}
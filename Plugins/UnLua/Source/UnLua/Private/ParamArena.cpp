@@ -0,0 +1,87 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+#include "ParamArena.h"
+#include "UnLuaPrivate.h"
+
+namespace UnLua
+{
+    FParamArena::FParamArena(int32 InCapacity)
+        : Memory(nullptr), Capacity(InCapacity), Top(0), HighWaterMark(0), NumFallbackAllocs(0)
+    {
+    }
+
+    FParamArena::~FParamArena()
+    {
+        DEC_MEMORY_STAT_BY(STAT_UnLua_ParamArena_HighWaterMark_Memory, HighWaterMark);
+        if (Memory)
+        {
+            UNLUA_STAT_MEMORY_FREE(Memory, PersistentParamBuffer);
+            FMemory::Free(Memory);
+        }
+    }
+
+    FParamArena::FScope::FScope(FParamArena& InArena)
+        : Arena(InArena), Mark(InArena.Top)
+    {
+    }
+
+    FParamArena::FScope::~FScope()
+    {
+        // rewinding to the mark also reclaims anything an inner scope failed to release
+        Arena.Top = Mark;
+        for (void* Block : HeapBlocks)
+            FMemory::Free(Block);
+    }
+
+    void* FParamArena::FScope::Alloc(int32 Size, int32 Alignment)
+    {
+        if (Size <= 0)
+            return nullptr;
+
+#if ENABLE_PERSISTENT_PARAM_BUFFER
+        const int32 Offset = Align(Arena.Top, Alignment);
+        if (Offset + Size <= Arena.Capacity)
+        {
+            if (!Arena.Memory)
+            {
+                Arena.Memory = (uint8*)FMemory::Malloc(Arena.Capacity, 16);
+                UNLUA_STAT_MEMORY_ALLOC(Arena.Memory, PersistentParamBuffer);
+            }
+
+            Arena.Top = Offset + Size;
+            if (Arena.Top > Arena.HighWaterMark)
+            {
+                INC_MEMORY_STAT_BY(STAT_UnLua_ParamArena_HighWaterMark_Memory, Arena.Top - Arena.HighWaterMark);
+                Arena.HighWaterMark = Arena.Top;
+            }
+            return Arena.Memory + Offset;
+        }
+
+        ++Arena.NumFallbackAllocs;
+        INC_DWORD_STAT(STAT_UnLua_ParamArena_FallbackAllocs);
+#endif
+        return AllocFromHeap(Size, Alignment);
+    }
+
+    void* FParamArena::FScope::AllocFromHeap(int32 Size, int32 Alignment)
+    {
+        if (Size <= 0)
+            return nullptr;
+
+        void* Block = FMemory::Malloc(Size, Alignment);
+        HeapBlocks.Add(Block);
+        return Block;
+    }
+}
@@ -0,0 +1,71 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace UnLua
+{
+    /**
+     * Stack-disciplined memory for UFunction parameters of Lua/UE crossings.
+     * Every crossing opens a scope, nested and recursive crossings stack on top of it,
+     * and the top is rewound when the scope ends. Requests that don't fit fall back to the heap.
+     * A Lua error longjmps past the scopes opened inside the failed call, so every protected call
+     * made from C++ (CallFunction, FLuaEnv::DoString...) opens a scope too and rewinds what they left.
+     */
+    class FParamArena
+    {
+    public:
+        static constexpr int32 DefaultCapacity = 64 * 1024;
+
+        class UNLUA_API FScope final
+        {
+        public:
+            explicit FScope(FParamArena& InArena);
+
+            ~FScope();
+
+            /** Allocate from the arena, or from the heap if it's full */
+            void* Alloc(int32 Size, int32 Alignment = 16);
+
+            /** Always allocate from the heap, for buffers whose address must not be reused right away */
+            void* AllocFromHeap(int32 Size, int32 Alignment = 16);
+
+        private:
+            FParamArena& Arena;
+            int32 Mark;
+            TArray<void*, TInlineAllocator<2>> HeapBlocks;
+        };
+
+        explicit FParamArena(int32 InCapacity = DefaultCapacity);
+
+        ~FParamArena();
+
+        FORCEINLINE int32 GetCapacity() const { return Capacity; }
+
+        FORCEINLINE int32 GetUsedSize() const { return Top; }
+
+        FORCEINLINE int32 GetHighWaterMark() const { return HighWaterMark; }
+
+        FORCEINLINE int32 GetNumFallbackAllocs() const { return NumFallbackAllocs; }
+
+    private:
+        uint8* Memory;
+        int32 Capacity;
+        int32 Top;
+        int32 HighWaterMark;
+        int32 NumFallbackAllocs;
+    };
+}
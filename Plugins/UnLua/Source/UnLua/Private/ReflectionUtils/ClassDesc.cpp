@@ -187,6 +187,23 @@ void FClassDesc::Load()
     RawStructPtr = Found;
 }
 
+void FClassDesc::SetMetatableRef(const UnLua::FLuaEnv* Env, int32 Ref)
+{
+    for (int32 i = 0; i < MetatableRefs.Num(); ++i)
+    {
+        if (MetatableRefs[i].Key != Env)
+            continue;
+        if (Ref == LUA_NOREF)
+            MetatableRefs.RemoveAtSwap(i);
+        else
+            MetatableRefs[i].Value = Ref;
+        return;
+    }
+
+    if (Ref != LUA_NOREF)
+        MetatableRefs.Emplace(Env, Ref);
+}
+
 void FClassDesc::UnLoad()
 {
     Fields.Empty();
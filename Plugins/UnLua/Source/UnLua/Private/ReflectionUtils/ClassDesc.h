@@ -15,11 +15,17 @@
 #pragma once
 
 #include "CoreUObject.h"
+#include "lua.hpp"
 
 class FPropertyDesc;
 class FFunctionDesc;
 class FFieldDesc;
 
+namespace UnLua
+{
+    class FLuaEnv;
+}
+
 /**
  * Class descriptor
  */
@@ -70,6 +76,21 @@ public:
 
     FORCEINLINE TSharedPtr<FFunctionDesc> GetFunction(int32 Index) { return Index > INDEX_NONE && Index < Functions.Num() ? Functions[Index] : nullptr; }
 
+    /**
+     * Get the registry reference of the metatable created for this class in the given env, LUA_NOREF if it's not created yet
+     */
+    FORCEINLINE int32 GetMetatableRef(const UnLua::FLuaEnv* Env) const
+    {
+        for (const TPair<const UnLua::FLuaEnv*, int32>& Pair : MetatableRefs)
+        {
+            if (Pair.Key == Env)
+                return Pair.Value;
+        }
+        return LUA_NOREF;
+    }
+
+    void SetMetatableRef(const UnLua::FLuaEnv* Env, int32 Ref);
+
     TSharedPtr<FFieldDesc> FindField(const char* FieldName);
 
     TSharedPtr<FFieldDesc> RegisterField(FName FieldName, FClassDesc *QueryClass = nullptr);
@@ -99,6 +120,7 @@ private:
     TArray<TSharedPtr<FPropertyDesc>> Properties;
     TArray<TSharedPtr<FFunctionDesc>> Functions;
     TArray<FClassDesc*> SuperClasses;
+    TArray<TPair<const UnLua::FLuaEnv*, int32>, TInlineAllocator<2>> MetatableRefs;
 
     struct FFunctionCollection *FunctionCollection;
 };
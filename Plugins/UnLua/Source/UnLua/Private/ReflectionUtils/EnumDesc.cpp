@@ -40,4 +40,22 @@ void FEnumDesc::UnLoad()
         return;
 
     Enum = nullptr;
+    ShortNames.Empty();
+}
+
+FName FEnumDesc::GetShortName(int32 Index) const
+{
+    check(Enum);
+    const int32 NumEntries = Enum->NumEnums();
+    if (ShortNames.Num() != NumEntries)
+    {
+        ShortNames.SetNum(NumEntries);
+        for (int32 i = 0; i < NumEntries; ++i)
+        {
+            const FString NameString = Enum->GetNameStringByIndex(i);
+            const FName Name(*NameString);
+            ShortNames[i] = Name.ToString() == NameString ? Name : NAME_None;
+        }
+    }
+    return ShortNames.IsValidIndex(Index) ? ShortNames[Index] : NAME_None;
 }
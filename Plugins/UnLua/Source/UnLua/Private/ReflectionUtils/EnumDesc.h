@@ -44,6 +44,11 @@ public:
 
     void UnLoad();
 
+    /**
+     * Get the name of an entry without the enum prefix, NAME_None if the name doesn't survive a round trip through FName
+     */
+    FName GetShortName(int32 Index) const;
+
     static int64 GetEnumValue(const UEnum* Enum, FName EntryName)
     {
         check(Enum);
@@ -73,5 +78,6 @@ private:
     };
 
     FString EnumName;
+    mutable TArray<FName> ShortNames;
     bool bUserDefined;
 };
@@ -24,12 +24,20 @@
 #include "Kismet/KismetSystemLibrary.h"
 #include "LuaDeadLoopCheck.h"
 
+bool GLuaDirectNativeCall = true;
+
+bool GLuaCrossingStats = false;
+
+uint32 FFunctionDesc::InterfaceFunctionCacheSerial = 0;
+
+TMap<TWeakObjectPtr<UFunction>, FFunctionDesc::FCrossingRecord> FFunctionDesc::CrossingRecords;
+
 /**
  * Function descriptor constructor
  */
 FFunctionDesc::FFunctionDesc(UFunction *InFunction, FParameterCollection *InDefaultParams)
     : DefaultParams(InDefaultParams), ReturnPropertyIndex(INDEX_NONE), LatentPropertyIndex(INDEX_NONE)
-    , NumRefProperties(0), NumCalls(0), bStaticFunc(false), bInterfaceFunc(false)
+    , NumRefProperties(0), bStaticFunc(false), bInterfaceFunc(false)
 {
     check(InFunction);
 
@@ -52,25 +60,15 @@ FFunctionDesc::FFunctionDesc(UFunction *InFunction, FParameterCollection *InDefa
     if (OuterClass->HasAnyClassFlags(CLASS_Interface) && OuterClass != UInterface::StaticClass())
     {
         bInterfaceFunc = true;                                          // a function in interface?
+        InterfaceFunctionCache = MakeUnique<FInterfaceFunctionCache>();
     }
 
-    bHasDelegateParams = false;
-    // create persistent parameter buffer. memory for speed
-#if ENABLE_PERSISTENT_PARAM_BUFFER
-    Buffer = nullptr;
-    if (InFunction->ParmsSize > 0)
-    {
-        Buffer = FMemory::Malloc(InFunction->ParmsSize, 16);
-        FMemory::Memzero(Buffer, InFunction->ParmsSize);
-        UNLUA_STAT_MEMORY_ALLOC(Buffer, Lua)
-    }
-#endif
+    // a local native function can skip callspace check and ProcessEvent, unless it has to be resolved or redirected per call,
+    // authority only and cosmetic functions are dropped by the callspace check on clients and dedicated servers
+    bDirectNativeCall = InFunction->HasAnyFunctionFlags(FUNC_Native) && !InFunction->HasAnyFunctionFlags(FUNC_Net | FUNC_BlueprintAuthorityOnly | FUNC_BlueprintCosmetic)
+        && !bInterfaceFunc && !InFunction->IsA<ULuaFunction>();
 
-    // pre-create OutParmRec. memory for speed
-#if !SUPPORTS_RPC_CALL
-    OutParmRec = nullptr;
-    FOutParmRec *CurrentOutParmRec = nullptr;
-#endif
+    bHasDelegateParams = false;
 
     static const FName NAME_LatentInfo = TEXT("LatentInfo");
     Properties.Reserve(InFunction->NumParms);
@@ -91,24 +89,6 @@ FFunctionDesc::FFunctionDesc(UFunction *InFunction, FParameterCollection *InDefa
         {
             ++NumRefProperties;
 
-            // pre-create OutParmRec for 'out' property
-#if !SUPPORTS_RPC_CALL
-            FOutParmRec *Out = (FOutParmRec*)FMemory::Malloc(sizeof(FOutParmRec), alignof(FOutParmRec));
-            UNLUA_STAT_MEMORY_ALLOC(Out, OutParmRec);
-            Out->PropAddr = Property->ContainerPtrToValuePtr<uint8>(Buffer);
-            Out->Property = Property;
-            if (CurrentOutParmRec)
-            {
-                CurrentOutParmRec->NextOutParm = Out;
-                CurrentOutParmRec = Out;
-            }
-            else
-            {
-                OutParmRec = Out;
-                CurrentOutParmRec = Out;
-            }
-#endif
-
             if (!Property->HasAnyPropertyFlags(CPF_ConstParm))
             {
                 OutPropertyIndices.Add(Index);                          // non-const reference property
@@ -128,12 +108,15 @@ FFunctionDesc::FFunctionDesc(UFunction *InFunction, FParameterCollection *InDefa
 
     }
 
-#if !SUPPORTS_RPC_CALL
-    if (CurrentOutParmRec)
+    // compile marshalling ops
+    ParamOps.Reserve(Properties.Num());
+    for (int32 i = 0; i < Properties.Num(); ++i)
     {
-        CurrentOutParmRec->NextOutParm = nullptr;
+        FParamOp Op = CompileParamOp(Properties[i].Get());
+        Op.bReturn = i == ReturnPropertyIndex;
+        Op.bLatent = i == LatentPropertyIndex;
+        ParamOps.Add(Op);
     }
-#endif
 }
 
 /**
@@ -144,31 +127,55 @@ FFunctionDesc::~FFunctionDesc()
 #if UNLUA_ENABLE_DEBUG != 0
     UE_LOG(LogUnLua, Log, TEXT("~FFunctionDesc : %s,%p"), *FuncName, this);
 #endif
+}
+
+const TMap<TWeakObjectPtr<UFunction>, FFunctionDesc::FCrossingRecord>& FFunctionDesc::GetCrossingRecords()
+{
+    return CrossingRecords;
+}
 
-    // free persistent parameter buffer
-#if ENABLE_PERSISTENT_PARAM_BUFFER
-    if (Buffer)
+void FFunctionDesc::ResetCrossingStats()
+{
+    CrossingRecords.Empty();
+}
+
+/**
+ * Accumulate timed calls of a function, it's listed for 'lua.stats crossings' on its first one
+ */
+void FFunctionDesc::AddCrossing(UFunction *Function, ECrossing Direction, int32 NumCalls, uint64 InclusiveCycles, uint64 MarshalCycles)
+{
+    if (!Function)
+        return;
+
+    FCrossingRecord *Record = CrossingRecords.Find(Function);
+    if (!Record)
     {
-        UNLUA_STAT_MEMORY_FREE(Buffer, PersistentParamBuffer);
-        FMemory::Free(Buffer);
+        Record = &CrossingRecords.Add(Function);
+        Record->Name = FString::Printf(TEXT("%s.%s"), *Function->GetOuter()->GetName(), *Function->GetName());
     }
-#endif
 
-    // free pre-created OutParmRec
-#if !SUPPORTS_RPC_CALL
-    while (OutParmRec)
+    FCrossingStats &Stats = Direction == ECrossing::LuaToUE ? Record->LuaToUE : Record->UEToLua;
+    Stats.NumCalls += NumCalls;
+    Stats.InclusiveCycles += InclusiveCycles;
+    Stats.MarshalCycles += MarshalCycles;
+
+    if (Direction == ECrossing::LuaToUE)
     {
-        FOutParmRec *NextOut = OutParmRec->NextOutParm;
-        UNLUA_STAT_MEMORY_FREE(OutParmRec, OutParmRec);
-        FMemory::Free(OutParmRec);
-        OutParmRec = NextOut;
+        INC_DWORD_STAT_BY(STAT_UnLua_Crossings_LuaToUE_Calls, NumCalls);
+        INC_FLOAT_STAT_BY(STAT_UnLua_Crossings_LuaToUE_Time, FPlatformTime::ToMilliseconds64(InclusiveCycles));
     }
-#endif
+    else
+    {
+        INC_DWORD_STAT_BY(STAT_UnLua_Crossings_UEToLua_Calls, NumCalls);
+        INC_FLOAT_STAT_BY(STAT_UnLua_Crossings_UEToLua_Time, FPlatformTime::ToMilliseconds64(InclusiveCycles));
+    }
+    INC_FLOAT_STAT_BY(STAT_UnLua_Crossings_Marshal_Time, FPlatformTime::ToMilliseconds64(MarshalCycles));
 }
 
 
 void FFunctionDesc::CallLua(lua_State* L, lua_Integer FunctionRef, lua_Integer SelfRef, FFrame& Stack, RESULT_DECL)
 {
+    FCrossingScope Crossing(Function.Get(), ECrossing::UEToLua);
     lua_pushcfunction(L, UnLua::ReportLuaCallError);
     check(Function.IsValid());
     lua_rawgeti(L, LUA_REGISTRYINDEX, FunctionRef);
@@ -178,15 +185,13 @@ void FFunctionDesc::CallLua(lua_State* L, lua_Integer FunctionRef, lua_Integer S
 
     void* InParms = nullptr;
     FOutParmRec* OutParms = Stack.OutParms;
+    UnLua::FParamArena::FScope ParamScope(UnLua::FLuaEnv::FindEnvChecked(L).GetParamArena());
     const bool bUnpackParams = Stack.CurrentNativeFunction && Stack.Node != Stack.CurrentNativeFunction;
     if (bUnpackParams)
     {
-#if ENABLE_PERSISTENT_PARAM_BUFFER
-        if (!bHasDelegateParams)
-            InParms = Buffer;
-#endif
-        if (!InParms)
-            InParms = ParmsSize > 0 ? FMemory::Malloc(ParmsSize, 16) : nullptr;
+        const uint64 UnpackStart = Crossing.Now();
+        // delegate parameters are tracked by address, don't hand the same address to the next call
+        InParms = bHasDelegateParams ? ParamScope.AllocFromHeap(ParmsSize) : ParamScope.Alloc(ParmsSize);
 
         FOutParmRec* FirstOut = nullptr;
         FOutParmRec* LastOut = nullptr;
@@ -230,35 +235,117 @@ void FFunctionDesc::CallLua(lua_State* L, lua_Integer FunctionRef, lua_Integer S
 
         check(Stack.PeekCode() == EX_EndFunctionParms);
         Stack.SkipCode(1); // skip EX_EndFunctionParms
+        Crossing.AddMarshal(UnpackStart);
     }
     else
     {
         InParms = Stack.Locals;
     }
 
-    CallLuaInternal(L, InParms , OutParms, RESULT_PARAM);
-
-    if (bUnpackParams && InParms)
-    {
-#if ENABLE_PERSISTENT_PARAM_BUFFER
-        if (bHasDelegateParams)
-#endif
-            FMemory::Free(InParms);
-    }
+    CallLuaInternal(L, InParms , OutParms, RESULT_PARAM, Crossing);
 }
 
 bool FFunctionDesc::CallLua(lua_State* L, int32 LuaRef, void* Params, UObject* Self)
 {
+    FCrossingScope Crossing(Function.Get(), ECrossing::UEToLua);
     bool bOk = PushFunction(L, Self, LuaRef);
     if (!bOk)
         return false;
 
     const bool bHasReturnParam = Function->ReturnValueOffset != MAX_uint16;
     uint8* ReturnValueAddress = bHasReturnParam ? ((uint8*)Params + Function->ReturnValueOffset) : nullptr;
-    bOk = CallLuaInternal(L, Params, nullptr, ReturnValueAddress);
+    bOk = CallLuaInternal(L, Params, nullptr, ReturnValueAddress, Crossing);
     return bOk;
 }
 
+/**
+ * Call the listeners pushed by FFunctionDesc::BroadcastLua, the stack layout is
+ * [NumListeners, (Ref, Serial, Function, Self) * NumListeners, Params...]
+ *
+ * @return - the number of listeners called
+ */
+static int32 DispatchLuaListeners(lua_State* L)
+{
+    const auto DelegateRegistry = UnLua::FLuaEnv::FindEnvChecked(L).GetDelegateRegistry();
+    const int32 NumListeners = (int32)lua_tointeger(L, 1);
+    const int32 FirstParamIndex = NumListeners * 4 + 2;
+    const int32 NumParams = lua_gettop(L) - FirstParamIndex + 1;
+    if (!lua_checkstack(L, NumParams + 4))
+        return luaL_error(L, "too many parameters to dispatch");
+
+    lua_pushcfunction(L, UnLua::ReportLuaCallError);
+    const int32 ErrorHandlerIndex = lua_gettop(L);
+    int32 NumCalled = 0;
+    for (int32 i = 0; i < NumListeners; ++i)
+    {
+        const int32 ListenerIndex = i * 4 + 2;
+
+        // a listener removed by a previous one has its reference released, and the reference may be taken
+        // by a listener added after it with the same function, so the serial must still be alive as well
+        if (!DelegateRegistry->IsListenerAlive((uint32)lua_tointeger(L, ListenerIndex + 1)))
+            continue;
+        lua_rawgeti(L, LUA_REGISTRYINDEX, lua_tointeger(L, ListenerIndex));
+        const bool bRemoved = !lua_rawequal(L, -1, ListenerIndex + 2);
+        lua_pop(L, 1);
+        if (bRemoved)
+            continue;
+
+        lua_pushvalue(L, ListenerIndex + 2);
+        lua_pushvalue(L, ListenerIndex + 3);
+        for (int32 j = 0; j < NumParams; ++j)
+            lua_pushvalue(L, FirstParamIndex + j);
+        if (lua_pcall(L, NumParams + 1, 0, ErrorHandlerIndex) != LUA_OK)
+            lua_pop(L, 1);
+        ++NumCalled;
+    }
+    lua_pushinteger(L, NumCalled);
+    return 1;
+}
+
+bool FFunctionDesc::BroadcastLua(lua_State* L, const int32* LuaRefs, const uint32* Serials, UObject* const* SelfObjects, int32 NumListeners, void* Params)
+{
+    check(CanBroadcastLua());
+    if (NumListeners < 1)
+        return true;
+
+    FCrossingScope Crossing(Function.Get(), ECrossing::UEToLua);
+    Crossing.SetNumCalls(0);
+
+    if (!lua_checkstack(L, NumListeners * 4 + Properties.Num() + 4))
+        return false;
+
+    // the functions are pushed before any of them runs, so listeners added during the broadcast wait for the next one
+    const uint64 MarshalStart = Crossing.Now();
+    lua_pushcfunction(L, UnLua::ReportLuaCallError);
+    lua_pushcfunction(L, DispatchLuaListeners);
+    lua_pushinteger(L, NumListeners);
+    int32 NumArgs = 1;
+    for (int32 i = 0; i < NumListeners; ++i)
+    {
+        lua_pushinteger(L, LuaRefs[i]);
+        lua_pushinteger(L, Serials[i]);
+        lua_rawgeti(L, LUA_REGISTRYINDEX, LuaRefs[i]);
+        UnLua::PushUObject(L, SelfObjects[i]);
+        NumArgs += 4;
+    }
+
+    for (const FParamOp& Op : ParamOps)
+    {
+        PushParamValue(L, Op, Params, false);
+        ++NumArgs;
+    }
+
+    Crossing.AddMarshal(MarshalStart);
+
+    const auto& Env = UnLua::FLuaEnv::FindEnvChecked(L);
+    const auto Guard = Env.GetDeadLoopCheck()->MakeGuard();
+    if (!CallFunction(L, NumArgs, 1))
+        return false;
+    Crossing.SetNumCalls((int32)lua_tointeger(L, -1));
+    lua_pop(L, 1);
+    return true;
+}
+
 /**
  * Call the UFunction
  */
@@ -294,6 +381,23 @@ int32 FFunctionDesc::CallUE(lua_State *L, int32 NumParams, void *Userdata)
         return 0;
     }
 
+    FCrossingScope Crossing(Function.Get(), ECrossing::LuaToUE);
+    UnLua::FParamArena::FScope ParamScope(UnLua::FLuaEnv::FindEnvChecked(L).GetParamArena());
+    FCleanupFlags CleanupFlags(false, Properties.Num());
+    uint64 MarshalStart = Crossing.Now();
+    void *Params = PreCall(L, NumParams, FirstParamIndex, ParamScope, CleanupFlags, Userdata);      // prepare values of properties
+    Crossing.AddMarshal(MarshalStart);
+
+    if (bDirectNativeCall && GLuaDirectNativeCall)
+    {
+        // local native function, nothing to resolve, invoke the thunk directly
+        CallNative(Object, Function.Get(), Params);
+        MarshalStart = Crossing.Now();
+        int32 NumReturnValues = PostCall(L, NumParams, FirstParamIndex, Params, CleanupFlags);  // push 'out' properties to Lua stack
+        Crossing.AddMarshal(MarshalStart);
+        return NumReturnValues;
+    }
+
 #if SUPPORTS_RPC_CALL
     int32 Callspace = Object->GetFunctionCallspace(Function.Get(), nullptr);
     bool bRemote = Callspace & FunctionCallspace::Remote;
@@ -303,28 +407,14 @@ int32 FFunctionDesc::CallUE(lua_State *L, int32 NumParams, void *Userdata)
     bool bLocal = true;
 #endif
 
-    TArray<bool> CleanupFlags;
-    CleanupFlags.AddZeroed(Properties.Num());
-    void *Params = PreCall(L, NumParams, FirstParamIndex, CleanupFlags, Userdata);      // prepare values of properties
-
     UFunction *FinalFunction = Function.Get();
     if (bInterfaceFunc)
     {
         // get target UFunction if it's a function in Interface
-        FName FunctionName = Function->GetFName();
-        FinalFunction = Object->GetClass()->FindFunctionByName(FunctionName);
+        FinalFunction = ResolveInterfaceFunction(Object->GetClass());
         if (!FinalFunction)
         {
             UNLUA_LOGERROR(L, LogUnLua, Error, TEXT("ERROR! Can't find UFunction '%s' in target object!"), *FuncName);
-
-            if (Params)
-            {
-#if ENABLE_PERSISTENT_PARAM_BUFFER
-                if (NumCalls > 0 || bHasDelegateParams)
-#endif	
-                    FMemory::Free(Params);
-            }
-
             return 0;
         }
 #if UE_BUILD_DEBUG
@@ -349,14 +439,9 @@ int32 FFunctionDesc::CallUE(lua_State *L, int32 NumParams, void *Userdata)
 
     // call the UFuncton...
 #if !SUPPORTS_RPC_CALL
-    if (FinalFunction == Function && FinalFunction->HasAnyFunctionFlags(FUNC_Native) && NumCalls == 1)
+    if (FinalFunction == Function && FinalFunction->HasAnyFunctionFlags(FUNC_Native))
     {
-        //FMemory::Memzero((uint8*)Params + FinalFunction->ParmsSize, FinalFunction->PropertiesSize - FinalFunction->ParmsSize);
-        uint8* ReturnValueAddress = FinalFunction->ReturnValueOffset != MAX_uint16 ? (uint8*)Params + FinalFunction->ReturnValueOffset : nullptr;
-        FMemory::Memcpy(Buffer, Params, Function->ParmsSize);
-        FFrame NewStack(Object, FinalFunction, Params, nullptr, GetChildProperties(Function));
-        NewStack.OutParms = OutParmRec;
-        FinalFunction->Invoke(Object, NewStack, ReturnValueAddress);
+        CallNative(Object, FinalFunction, Params);
     }
     else
 #endif
@@ -373,10 +458,107 @@ int32 FFunctionDesc::CallUE(lua_State *L, int32 NumParams, void *Userdata)
         }
     }
 
+    MarshalStart = Crossing.Now();
     int32 NumReturnValues = PostCall(L, NumParams, FirstParamIndex, Params, CleanupFlags);      // push 'out' properties to Lua stack
+    Crossing.AddMarshal(MarshalStart);
     return NumReturnValues;
 }
 
+/**
+ * Find the implementation of this interface function in a class, through the inline cache
+ */
+UFunction* FFunctionDesc::ResolveInterfaceFunction(UClass *Class)
+{
+    FInterfaceFunctionCache &Cache = *InterfaceFunctionCache;
+    if (Cache.Serial != InterfaceFunctionCacheSerial)
+    {
+        Cache.Num = 0;
+        Cache.NextVictim = 1;
+        Cache.Serial = InterfaceFunctionCacheSerial;
+    }
+
+    // the class may have been unloaded and its address reused, so the function must still be alive
+    for (int32 i = 0; i < Cache.Num; ++i)
+    {
+        FInterfaceFunctionCache::FEntry &Entry = Cache.Entries[i];
+        if (Entry.Class != Class)
+            continue;
+        UFunction *Found = Entry.Function.Get();
+        if (!Found)
+            break;
+        if (i > 0)
+            Swap(Cache.Entries[0], Entry);                              // keep the latest class monomorphic
+        return Found;
+    }
+
+    UFunction *Found = Class->FindFunctionByName(Function->GetFName());
+    if (!Found)
+        return nullptr;
+
+    int32 Slot = 0;
+    for (int32 i = 0; i < Cache.Num; ++i)
+    {
+        if (Cache.Entries[i].Class == Class)
+        {
+            Slot = i;                                                   // replace the stale entry
+            break;
+        }
+    }
+    if (Slot == 0 && Cache.Num > 0 && Cache.Entries[0].Class != Class)
+    {
+        // demote the monomorphic entry to the polymorphic table
+        if (Cache.Num < FInterfaceFunctionCache::NumEntries)
+        {
+            Slot = Cache.Num++;
+        }
+        else
+        {
+            Slot = Cache.NextVictim;
+            Cache.NextVictim = Cache.NextVictim + 1 < FInterfaceFunctionCache::NumEntries ? Cache.NextVictim + 1 : 1;
+        }
+        Cache.Entries[Slot] = Cache.Entries[0];
+        Slot = 0;
+    }
+    else if (Cache.Num == 0)
+    {
+        Cache.Num = 1;
+    }
+    Cache.Entries[Slot].Class = Class;
+    Cache.Entries[Slot].Function = Found;
+    return Found;
+}
+
+void FFunctionDesc::InvalidateInterfaceFunctionCaches()
+{
+    ++InterfaceFunctionCacheSerial;
+}
+
+/**
+ * Invoke the native thunk of a UFunction with a prepared parameter buffer, bypassing UObject::ProcessEvent
+ */
+void FFunctionDesc::CallNative(UObject *Object, UFunction *FinalFunction, void *Params) const
+{
+    uint8* ReturnValueAddress = FinalFunction->ReturnValueOffset != MAX_uint16 ? (uint8*)Params + FinalFunction->ReturnValueOffset : nullptr;
+    FFrame NewStack(Object, FinalFunction, Params, nullptr, GetChildProperties(FinalFunction));
+
+    // out parameters live in the parameter buffer of this call
+    FOutParmRec** LastOut = &NewStack.OutParms;
+    for (const auto& Property : Properties)
+    {
+        if (!Property->GetProperty()->HasAnyPropertyFlags(CPF_OutParm))
+            continue;
+        CA_SUPPRESS(6263)
+        FOutParmRec* Out = (FOutParmRec*)FMemory_Alloca(sizeof(FOutParmRec));
+        Out->PropAddr = Property->GetProperty()->ContainerPtrToValuePtr<uint8>(Params);
+        Out->Property = Property->GetProperty();
+        *LastOut = Out;
+        LastOut = &Out->NextOutParm;
+    }
+    *LastOut = nullptr;
+
+    FinalFunction->Invoke(Object, NewStack, ReturnValueAddress);
+}
+
 /**
  * Fire a delegate
  */
@@ -387,9 +569,9 @@ int32 FFunctionDesc::ExecuteDelegate(lua_State *L, int32 NumParams, int32 FirstP
         return 0;
     }
 
-    TArray<bool> CleanupFlags;
-    CleanupFlags.AddZeroed(Properties.Num());
-    void *Params = PreCall(L, NumParams, FirstParamIndex, CleanupFlags);
+    UnLua::FParamArena::FScope ParamScope(UnLua::FLuaEnv::FindEnvChecked(L).GetParamArena());
+    FCleanupFlags CleanupFlags(false, Properties.Num());
+    void *Params = PreCall(L, NumParams, FirstParamIndex, ParamScope, CleanupFlags);
     ScriptDelegate->ProcessDelegate<UObject>(Params);
     int32 NumReturnValues = PostCall(L, NumParams, FirstParamIndex, Params, CleanupFlags);
     return NumReturnValues;
@@ -405,9 +587,9 @@ void FFunctionDesc::BroadcastMulticastDelegate(lua_State *L, int32 NumParams, in
         return;
     }
 
-    TArray<bool> CleanupFlags;
-    CleanupFlags.AddZeroed(Properties.Num());
-    void *Params = PreCall(L, NumParams, FirstParamIndex, CleanupFlags);
+    UnLua::FParamArena::FScope ParamScope(UnLua::FLuaEnv::FindEnvChecked(L).GetParamArena());
+    FCleanupFlags CleanupFlags(false, Properties.Num());
+    void *Params = PreCall(L, NumParams, FirstParamIndex, ParamScope, CleanupFlags);
     ScriptDelegate->ProcessMulticastDelegate<UObject>(Params);
     PostCall(L, NumParams, FirstParamIndex, Params, CleanupFlags);      // !!! have no return values for multi-cast delegates
 }
@@ -415,28 +597,22 @@ void FFunctionDesc::BroadcastMulticastDelegate(lua_State *L, int32 NumParams, in
 /**
  * Prepare values of properties for the UFunction
  */
-void* FFunctionDesc::PreCall(lua_State *L, int32 NumParams, int32 FirstParamIndex, TArray<bool> &CleanupFlags, void *Userdata)
+void* FFunctionDesc::PreCall(lua_State *L, int32 NumParams, int32 FirstParamIndex, UnLua::FParamArena::FScope &ParamScope, FCleanupFlags &CleanupFlags, void *Userdata)
 {
-    // !!!Fix!!!
-    // use simple pool
-    void *Params = nullptr;
-#if ENABLE_PERSISTENT_PARAM_BUFFER
-    if (NumCalls < 1 && !bHasDelegateParams)
-    {
-        Params = Buffer;
-    }
-    else
-#endif
-    Params = Function->ParmsSize > 0 ? FMemory::Malloc(Function->ParmsSize, 16) : nullptr;
-
-    ++NumCalls;
+    // the buffer is released when the scope of this call ends
+    void *Params = bHasDelegateParams ? ParamScope.AllocFromHeap(Function->ParmsSize) : ParamScope.Alloc(Function->ParmsSize);
 
     int32 ParamIndex = 0;
-    for (int32 i = 0; i < Properties.Num(); ++i)
+    for (int32 i = 0; i < ParamOps.Num(); ++i)
     {
-        const auto& Property = Properties[i];
-        Property->InitializeValue(Params);
-        if (i == LatentPropertyIndex)
+        const FParamOp& Op = ParamOps[i];
+        FPropertyDesc* Property = Op.Desc;
+        if (Op.Kind == FParamOp::Generic)
+            Property->InitializeValue(Params);
+        else
+            FMemory::Memzero((uint8*)Params + Op.Offset, Op.Size);
+
+        if (Op.bLatent)
         {
             const int32 ThreadRef = *((int32*)Userdata);
             void* ContainerPtr = (uint8*)Params;// + Property->GetOffset();
@@ -454,21 +630,24 @@ void* FFunctionDesc::PreCall(lua_State *L, int32 NumParams, int32 FirstParamInde
             Property->CopyValue(ContainerPtr, &LatentActionInfo);
             continue;
         }
-        if (i == ReturnPropertyIndex)
+        if (Op.bReturn)
         {
-            CleanupFlags[i] = ParamIndex < NumParams ? !Property->CopyBack(L, FirstParamIndex + ParamIndex, Params) : true;
+            CleanupFlags[i] = ParamIndex < NumParams && !Op.IsScalar() ? !Property->CopyBack(L, FirstParamIndex + ParamIndex, Params) : true;
             continue;
         }
         if (ParamIndex < NumParams)
         {   
 #if ENABLE_TYPE_CHECK == 1
-            FString ErrorMsg = "";
-            if (!Property->CheckPropertyType(L, FirstParamIndex + ParamIndex, ErrorMsg))
+            if (!CheckParamType(L, Op, FirstParamIndex + ParamIndex))
             {
-                UNLUA_LOGERROR(L, LogUnLua, Warning, TEXT("Invalid parameter type calling ufunction : %s,parameter : %d, error msg : %s"), *FuncName, ParamIndex, *ErrorMsg);
+                FString ErrorMsg = "";
+                if (!Property->CheckPropertyType(L, FirstParamIndex + ParamIndex, ErrorMsg))
+                {
+                    UNLUA_LOGERROR(L, LogUnLua, Warning, TEXT("Invalid parameter type calling ufunction : %s,parameter : %d, error msg : %s"), *FuncName, ParamIndex, *ErrorMsg);
+                }
             }
 #endif
-            CleanupFlags[i] = Property->SetValue(L, Params, FirstParamIndex + ParamIndex, false);
+            CleanupFlags[i] = SetParamValue(L, Op, Params, FirstParamIndex + ParamIndex);
         }
         else if (!Property->IsOutParameter())
         {
@@ -503,17 +682,17 @@ void* FFunctionDesc::PreCall(lua_State *L, int32 NumParams, int32 FirstParamInde
 /**
  * Handling 'out' properties
  */
-int32 FFunctionDesc::PostCall(lua_State *L, int32 NumParams, int32 FirstParamIndex, void *Params, const TArray<bool> &CleanupFlags)
+int32 FFunctionDesc::PostCall(lua_State *L, int32 NumParams, int32 FirstParamIndex, void *Params, const FCleanupFlags &CleanupFlags)
 {
     int32 NumReturnValues = 0;
 
 #if UNLUA_LEGACY_RETURN_ORDER
     for (int32 Index : OutPropertyIndices)
     {
-        const auto& Property = Properties[Index];
-        if (Index >= NumParams || !Property->CopyBack(L, Params, FirstParamIndex + Index))
+        const FParamOp& Op = ParamOps[Index];
+        if (Index >= NumParams || Op.IsScalar() || !Op.Desc->CopyBack(L, Params, FirstParamIndex + Index))
         {
-            Property->GetValue(L, Params, true);
+            PushParamValue(L, Op, Params, true);
             ++NumReturnValues;
         }
     }
@@ -521,17 +700,17 @@ int32 FFunctionDesc::PostCall(lua_State *L, int32 NumParams, int32 FirstParamInd
 
     if (ReturnPropertyIndex > INDEX_NONE)
     {
-        const auto& Property = Properties[ReturnPropertyIndex];
+        const FParamOp& Op = ParamOps[ReturnPropertyIndex];
         if (!CleanupFlags[ReturnPropertyIndex])
         {
             int32 ReturnIndexInStack = FirstParamIndex + ReturnPropertyIndex;
-            bool bResult = Property->CopyBack(L, Params, ReturnIndexInStack);
+            bool bResult = Op.Desc->CopyBack(L, Params, ReturnIndexInStack);
             check(bResult);
             lua_pushvalue(L, ReturnIndexInStack);
         }
         else
         {
-            Property->GetValue(L, Params, true);
+            PushParamValue(L, Op, Params, true);
         }
         ++NumReturnValues;
     }
@@ -543,34 +722,217 @@ int32 FFunctionDesc::PostCall(lua_State *L, int32 NumParams, int32 FirstParamInd
     // c++ may has return and out params, we must push it on stack
     for (int32 Index : OutPropertyIndices)
     {
-        const auto& Property = Properties[Index];
-        if (Index >= NumParams || !Property->CopyBack(L, Params, FirstParamIndex + Index))
+        const FParamOp& Op = ParamOps[Index];
+        if (Index >= NumParams || Op.IsScalar() || !Op.Desc->CopyBack(L, Params, FirstParamIndex + Index))
         {
-            Property->GetValue(L, Params, true);
+            PushParamValue(L, Op, Params, true);
             ++NumReturnValues;
         }
     }
 #endif
 
-    for (int32 i = 0; i < Properties.Num(); ++i)
+    for (int32 i = 0; i < ParamOps.Num(); ++i)
     {
-        if (CleanupFlags[i])
+        if (CleanupFlags[i] && ParamOps[i].Kind == FParamOp::Generic)
         {
-            Properties[i]->DestroyValue(Params);
+            ParamOps[i].Desc->DestroyValue(Params);
         }
     }
 
-    --NumCalls;
+    return NumReturnValues;
+}
+
+/**
+ * Pick the specialized marshalling op for a property
+ */
+FFunctionDesc::FParamOp FFunctionDesc::CompileParamOp(FPropertyDesc *PropertyDesc)
+{
+    FProperty *Property = PropertyDesc->GetProperty();
+
+    FParamOp Op;
+    Op.Desc = PropertyDesc;
+    Op.Offset = Property->GetOffset_ForInternal();
+    Op.Size = Property->GetSize();
+    Op.Kind = FParamOp::Generic;
+    Op.bReturn = false;
+    Op.bLatent = false;
+
+    if (Property->ArrayDim != 1)
+        return Op;
 
-    if (Params)
+    if (Property->IsA<FIntProperty>())
+    {
+        Op.Kind = FParamOp::Int32;
+    }
+    else if (Property->IsA<FInt64Property>())
+    {
+        Op.Kind = FParamOp::Int64;
+    }
+    else if (Property->IsA<FFloatProperty>())
+    {
+        Op.Kind = FParamOp::Float;
+    }
+    else if (Property->IsA<FDoubleProperty>())
     {
-#if ENABLE_PERSISTENT_PARAM_BUFFER
-        if (NumCalls > 0 || bHasDelegateParams)
-#endif	
-        FMemory::Free(Params);
+        Op.Kind = FParamOp::Double;
     }
+    else if (const FBoolProperty *BoolProperty = CastField<FBoolProperty>(Property))
+    {
+        if (BoolProperty->IsNativeBool())
+            Op.Kind = FParamOp::Bool;
+    }
+    else if (Property->IsA<FByteProperty>())
+    {
+        Op.Kind = FParamOp::Byte;
+    }
+    else if (const FEnumProperty *EnumProperty = CastField<FEnumProperty>(Property))
+    {
+        if (EnumProperty->GetUnderlyingProperty()->IsA<FByteProperty>())
+            Op.Kind = FParamOp::Byte;
+    }
+    else if (Property->IsA<FNameProperty>())
+    {
+        Op.Kind = FParamOp::Name;
+    }
+    else if (Property->IsA<FObjectProperty>() && !Property->IsA<FClassProperty>())
+    {
+        Op.Kind = FParamOp::Object;
+    }
+    else if (Property->IsA<FStructProperty>() && Property->HasAllPropertyFlags(CPF_IsPlainOldData | CPF_ZeroConstructor))
+    {
+        Op.Kind = FParamOp::PODStruct;
+    }
+    return Op;
+}
 
-    return NumReturnValues;
+/**
+ * Cheap type check for specialized ops, the property descriptor does the full check if it fails
+ */
+bool FFunctionDesc::CheckParamType(lua_State *L, const FParamOp &Op, int32 IndexInStack)
+{
+    const int32 Type = lua_type(L, IndexInStack);
+    if (Type == LUA_TNIL)
+        return true;
+
+    switch (Op.Kind)
+    {
+    case FParamOp::Int32:
+    case FParamOp::Int64:
+    case FParamOp::Byte:
+        return lua_isinteger(L, IndexInStack) != 0;
+    case FParamOp::Float:
+    case FParamOp::Double:
+        return Type == LUA_TNUMBER;
+    case FParamOp::Bool:
+        return Type == LUA_TBOOLEAN;
+    case FParamOp::Name:
+        return Type == LUA_TSTRING || Type == LUA_TNUMBER;
+    case FParamOp::Object:
+        {
+            const UObject *Object = UnLua::GetUObject(L, IndexInStack);
+            return !Object || Object->GetClass()->IsChildOf(((FObjectProperty*)Op.Desc->GetProperty())->PropertyClass);
+        }
+    case FParamOp::PODStruct:
+        {
+            // exact struct only, derived structs are left to the full check
+            if (Type != LUA_TUSERDATA)
+                return false;
+            const FClassDesc *ClassDesc = UnLua::FClassRegistry::Find(((FStructProperty*)Op.Desc->GetProperty())->Struct);
+            const int32 MetatableRef = ClassDesc ? ClassDesc->GetMetatableRef(&UnLua::FLuaEnv::FindEnvChecked(L)) : LUA_NOREF;
+            if (MetatableRef == LUA_NOREF || !lua_getmetatable(L, IndexInStack))
+                return false;
+            lua_rawgeti(L, LUA_REGISTRYINDEX, MetatableRef);
+            const bool bSameStruct = lua_rawequal(L, -1, -2) != 0;
+            lua_pop(L, 2);
+            return bSameStruct;
+        }
+    default:
+        return false;
+    }
+}
+
+/**
+ * Set the value of a parameter from the given Lua index
+ *
+ * @return - true if the value should be cleaned up after the call
+ */
+bool FFunctionDesc::SetParamValue(lua_State *L, const FParamOp &Op, void *Params, int32 IndexInStack)
+{
+    void *ValuePtr = (uint8*)Params + Op.Offset;
+    switch (Op.Kind)
+    {
+    case FParamOp::Int32:
+        *(int32*)ValuePtr = (int32)lua_tointeger(L, IndexInStack);
+        return false;
+    case FParamOp::Int64:
+        *(int64*)ValuePtr = (int64)lua_tointeger(L, IndexInStack);
+        return false;
+    case FParamOp::Float:
+        *(float*)ValuePtr = (float)lua_tonumber(L, IndexInStack);
+        return false;
+    case FParamOp::Double:
+        *(double*)ValuePtr = (double)lua_tonumber(L, IndexInStack);
+        return false;
+    case FParamOp::Bool:
+        *(bool*)ValuePtr = lua_toboolean(L, IndexInStack) != 0;
+        return false;
+    case FParamOp::Byte:
+        *(uint8*)ValuePtr = (uint8)lua_tointeger(L, IndexInStack);
+        return false;
+    case FParamOp::Name:
+        *(FName*)ValuePtr = UnLua::FLuaEnv::FindEnvChecked(L).GetNameRegistry()->ToName(L, IndexInStack);
+        return false;
+    case FParamOp::Object:
+        FObjectProperty::SetPropertyValue(ValuePtr, UnLua::GetUObject(L, IndexInStack));
+        return false;
+    case FParamOp::PODStruct:
+        {
+            const void *Value = GetCppInstanceFast(L, IndexInStack);
+            if (Value)
+                FMemory::Memcpy(ValuePtr, Value, Op.Size);
+            return false;
+        }
+    default:
+        return Op.Desc->SetValue(L, Params, IndexInStack, false);
+    }
+}
+
+/**
+ * Push the value of a parameter to the Lua stack
+ */
+void FFunctionDesc::PushParamValue(lua_State *L, const FParamOp &Op, const void *Params, bool bCreateCopy)
+{
+    const void *ValuePtr = (const uint8*)Params + Op.Offset;
+    switch (Op.Kind)
+    {
+    case FParamOp::Int32:
+        lua_pushinteger(L, *(const int32*)ValuePtr);
+        break;
+    case FParamOp::Int64:
+        lua_pushinteger(L, *(const int64*)ValuePtr);
+        break;
+    case FParamOp::Float:
+        lua_pushnumber(L, *(const float*)ValuePtr);
+        break;
+    case FParamOp::Double:
+        lua_pushnumber(L, *(const double*)ValuePtr);
+        break;
+    case FParamOp::Bool:
+        lua_pushboolean(L, *(const bool*)ValuePtr);
+        break;
+    case FParamOp::Byte:
+        lua_pushinteger(L, *(const uint8*)ValuePtr);
+        break;
+    case FParamOp::Name:
+        UnLua::FLuaEnv::FindEnvChecked(L).GetNameRegistry()->Push(L, *(const FName*)ValuePtr);
+        break;
+    case FParamOp::Object:
+        UnLua::PushUObject(L, FObjectProperty::GetPropertyValue(ValuePtr));
+        break;
+    default:
+        Op.Desc->GetValue(L, Params, bCreateCopy);
+        break;
+    }
 }
 
 /**
@@ -592,18 +954,19 @@ static FOutParmRec* FindOutParmRec(FOutParmRec *OutParam, FProperty *OutProperty
 /**
  * Call Lua function that overrides this UFunction. 
  */
-bool FFunctionDesc::CallLuaInternal(lua_State *L, void *InParams, FOutParmRec *OutParams, void *RetValueAddress) const
+bool FFunctionDesc::CallLuaInternal(lua_State *L, void *InParams, FOutParmRec *OutParams, void *RetValueAddress, FCrossingScope &Crossing) const
 {
     // prepare parameters for Lua function
+    uint64 MarshalStart = Crossing.Now();
     FOutParmRec *OutParam = OutParams;
-    for (const auto& Property : Properties)
+    for (const FParamOp& Op : ParamOps)
     {
-        if (Property->IsReturnParameter())
+        if (Op.bReturn)
         {
             continue;
         }
 
-        Property->GetValue(L, InParams, false);
+        PushParamValue(L, Op, InParams, false);
     }
 
     // object is also pushed, return is push when return
@@ -618,6 +981,7 @@ bool FFunctionDesc::CallLuaInternal(lua_State *L, void *InParams, FOutParmRec *O
         NumResult++;
     }
 
+    Crossing.AddMarshal(MarshalStart);
     const auto& Env = UnLua::FLuaEnv::FindEnvChecked(L);
     const auto Guard = Env.GetDeadLoopCheck()->MakeGuard();
     bool bSuccess = CallFunction(L, NumParams, NumResult);      // pcall
@@ -626,6 +990,8 @@ bool FFunctionDesc::CallLuaInternal(lua_State *L, void *InParams, FOutParmRec *O
         return false;
     }
 
+    MarshalStart = Crossing.Now();
+
     // out value
     // suppose out param is also pushed on stack? this is assumed done by user... so we can not trust it
     int32 NumResultOnStack = lua_gettop(L);
@@ -700,6 +1066,7 @@ bool FFunctionDesc::CallLuaInternal(lua_State *L, void *InParams, FOutParmRec *O
     }
 
     lua_pop(L, NumResult);
+    Crossing.AddMarshal(MarshalStart);
     return true;
 }
 
@@ -16,17 +16,91 @@
 
 #include "lua.hpp"
 #include "Registries/FunctionRegistry.h"
+#include "ParamArena.h"
 
 struct lua_State;
 struct FParameterCollection;
 class FPropertyDesc;
 
+/**
+ * Cleanup flags of parameters, stored inline for functions with up to 64 parameters
+ */
+typedef TBitArray<TInlineAllocator<2>> FCleanupFlags;
+
+/**
+ * Whether native non-RPC UFunctions are invoked through their thunks directly, see UUnLuaSettings::bDirectNativeCall
+ */
+UNLUA_API extern bool GLuaDirectNativeCall;
+
+/**
+ * Whether calls crossing between Lua and UE are counted and timed per function, switched by 'lua.stats crossings on|off'
+ */
+UNLUA_API extern bool GLuaCrossingStats;
+
 /**
  * Function descriptor
  */
 class FFunctionDesc
 {
 public:
+    enum class ECrossing : uint8
+    {
+        LuaToUE,
+        UEToLua,
+    };
+
+    /**
+     * Statistics of the calls through a function in one direction, in CPU cycles
+     */
+    struct FCrossingStats
+    {
+        uint64 NumCalls = 0;
+        uint64 InclusiveCycles = 0;
+        uint64 MarshalCycles = 0;       // converting parameters and results between Lua and UE
+    };
+
+    /**
+     * Crossing statistics of a function, kept apart from descriptors which may be released while they are called
+     */
+    struct FCrossingRecord
+    {
+        FString Name;                   // Outer.Function, the function may be gone when the statistics are dumped
+        FCrossingStats LuaToUE;
+        FCrossingStats UEToLua;
+    };
+
+    /**
+     * Times a call while crossing statistics are on, costs a branch otherwise
+     */
+    class FCrossingScope
+    {
+    public:
+        FCrossingScope(UFunction *InFunction, ECrossing InDirection)
+            : Function(InFunction), Direction(InDirection), StartCycles(GLuaCrossingStats ? FPlatformTime::Cycles64() : 0), MarshalCycles(0), NumCalls(1)
+        {
+        }
+
+        ~FCrossingScope()
+        {
+            if (StartCycles && NumCalls > 0)
+                AddCrossing(Function, Direction, NumCalls, FPlatformTime::Cycles64() - StartCycles, MarshalCycles);
+        }
+
+        FORCEINLINE uint64 Now() const { return StartCycles ? FPlatformTime::Cycles64() : 0; }
+
+        FORCEINLINE void AddMarshal(uint64 Since) { if (StartCycles) MarshalCycles += FPlatformTime::Cycles64() - Since; }
+
+        /** a batched broadcast crosses once for each listener it calls */
+        FORCEINLINE void SetNumCalls(int32 InNumCalls) { NumCalls = InNumCalls; }
+
+    private:
+        UFunction *Function;
+        ECrossing Direction;
+        uint64 StartCycles;
+        uint64 MarshalCycles;
+        int32 NumCalls;
+    };
+
     FFunctionDesc(UFunction *InFunction, FParameterCollection *InDefaultParams);
     ~FFunctionDesc();
 
@@ -80,10 +154,41 @@ public:
     FORCEINLINE UFunction* GetFunction() const { return Function.Get(); }
 
     FORCEINLINE const char* GetLuaFunctionName() const { return LuaFunctionName->Get(); }
+
+    FORCEINLINE const FString& GetName() const { return FuncName; }
+
+    /**
+     * Get crossing statistics of the functions called since the last reset
+     */
+    static const TMap<TWeakObjectPtr<UFunction>, FCrossingRecord>& GetCrossingRecords();
+
+    /**
+     * Clear crossing statistics of all functions
+     */
+    static void ResetCrossingStats();
  
     void CallLua(lua_State* L, lua_Integer FunctionRef, lua_Integer SelfRef, FFrame& Stack, RESULT_DECL);
  
     bool CallLua(lua_State* L, int32 LuaRef, void* Params, UObject* Self);
+
+    /**
+     * Test if Lua listeners of this signature can be called in a batch, which is the case when nothing is copied back from Lua
+     *
+     * @return - true if the function has neither return property nor non-const reference properties
+     */
+    FORCEINLINE bool CanBroadcastLua() const { return ReturnPropertyIndex == INDEX_NONE && OutPropertyIndices.Num() == 0; }
+
+    /**
+     * Call a batch of Lua listeners in a single Lua entry, the parameters are pushed to Lua only once
+     *
+     * @param LuaRefs - references of the Lua functions, in calling order
+     * @param Serials - serials of the listeners, checked with the references before each call
+     * @param SelfObjects - the object passed as the first parameter of each Lua function
+     * @param NumListeners - the number of listeners
+     * @param Params - parameters of the signature
+     * @return - true if the batch was dispatched
+     */
+    bool BroadcastLua(lua_State* L, const int32* LuaRefs, const uint32* Serials, UObject* const* SelfObjects, int32 NumListeners, void* Params);
  
     /**
      * Call this UFunction
@@ -113,30 +218,94 @@ public:
      */
     void BroadcastMulticastDelegate(lua_State *L, int32 NumParams, int32 FirstParamIndex, FMulticastScriptDelegate *ScriptDelegate);
 
+    /**
+     * Invalidate resolved interface functions of all descriptors, called when classes are unloaded or recompiled
+     */
+    static void InvalidateInterfaceFunctionCaches();
+
    private:
-    void* PreCall(lua_State *L, int32 NumParams, int32 FirstParamIndex, TArray<bool> &CleanupFlags, void *Userdata = nullptr);
-    int32 PostCall(lua_State *L, int32 NumParams, int32 FirstParamIndex, void *Params, const TArray<bool> &CleanupFlags);
+    /**
+     * Marshalling op of a parameter, compiled when the descriptor is built
+     */
+    struct FParamOp
+    {
+        enum EKind : uint8
+        {
+            Generic,        // go through the property descriptor
+            Int32,
+            Int64,
+            Float,
+            Double,
+            Bool,           // native bool
+            Byte,           // uint8, and enums based on uint8
+            Name,
+            Object,         // hard object reference
+            PODStruct,      // zero constructed plain old data struct
+        };
+
+        FPropertyDesc *Desc;
+        int32 Offset;
+        int32 Size;
+        EKind Kind;
+        uint8 bReturn : 1;
+        uint8 bLatent : 1;
+
+        /** scalar values never copy back to Lua and need no destruction */
+        FORCEINLINE bool IsScalar() const { return Kind != Generic && Kind != Object && Kind != PODStruct; }
+    };
+
+    /**
+     * Inline cache of implementations of an interface function, the first entry is the monomorphic one
+     */
+    struct FInterfaceFunctionCache
+    {
+        enum { NumEntries = 5 };
+
+        struct FEntry
+        {
+            const UClass *Class;
+            TWeakObjectPtr<UFunction> Function;
+        };
 
-    bool CallLuaInternal(lua_State *L, void *InParams, FOutParmRec *OutParams, void *RetValueAddress) const;
+        FEntry Entries[NumEntries];
+        int32 Num = 0;
+        int32 NextVictim = 1;
+        uint32 Serial = 0;
+    };
+
+    UFunction* ResolveInterfaceFunction(UClass *Class);
+
+    static FParamOp CompileParamOp(FPropertyDesc *PropertyDesc);
+    static bool CheckParamType(lua_State *L, const FParamOp &Op, int32 IndexInStack);
+    static bool SetParamValue(lua_State *L, const FParamOp &Op, void *Params, int32 IndexInStack);
+    static void PushParamValue(lua_State *L, const FParamOp &Op, const void *Params, bool bCreateCopy);
+
+    void* PreCall(lua_State *L, int32 NumParams, int32 FirstParamIndex, UnLua::FParamArena::FScope &ParamScope, FCleanupFlags &CleanupFlags, void *Userdata = nullptr);
+    int32 PostCall(lua_State *L, int32 NumParams, int32 FirstParamIndex, void *Params, const FCleanupFlags &CleanupFlags);
+
+    bool CallLuaInternal(lua_State *L, void *InParams, FOutParmRec *OutParams, void *RetValueAddress, FCrossingScope &Crossing) const;
+
+    static void AddCrossing(UFunction *Function, ECrossing Direction, int32 NumCalls, uint64 InclusiveCycles, uint64 MarshalCycles);
+
+    void CallNative(UObject *Object, UFunction *FinalFunction, void *Params) const;
 
     TWeakObjectPtr<UFunction> Function;
     FString FuncName;
-#if ENABLE_PERSISTENT_PARAM_BUFFER
-    void *Buffer;
-#endif
-#if !SUPPORTS_RPC_CALL
-    FOutParmRec *OutParmRec;
-#endif
     TArray<TUniquePtr<FPropertyDesc>> Properties;
+    TArray<FParamOp> ParamOps;
     TArray<int32> OutPropertyIndices;
     FParameterCollection *DefaultParams;
     int32 ReturnPropertyIndex;
     int32 LatentPropertyIndex;
     uint8 NumRefProperties;
-    uint8 NumCalls;                 // RECURSE_LIMIT is 120 or 250 which is less than 256, so use a byte...
     uint8 bStaticFunc : 1;
     uint8 bInterfaceFunc : 1;
     uint8 bHasDelegateParams : 1;
+    uint8 bDirectNativeCall : 1;
     int32 ParmsSize;
     TUniquePtr<FTCHARToUTF8> LuaFunctionName;
+    TUniquePtr<FInterfaceFunctionCache> InterfaceFunctionCache;
+
+    static uint32 InterfaceFunctionCacheSerial;
+    static TMap<TWeakObjectPtr<UFunction>, FCrossingRecord> CrossingRecords;
 };
@@ -597,13 +597,13 @@ public:
         }
         else
         {
-            lua_pushstring(L, TCHAR_TO_UTF8(*NameProperty->GetPropertyValue(ValuePtr).ToString()));
+            UnLua::FLuaEnv::FindEnvChecked(L).GetNameRegistry()->Push(L, NameProperty->GetPropertyValue(ValuePtr));
         }
     }
 
     virtual bool SetValueInternal(lua_State *L, void *ValuePtr, int32 IndexInStack, bool bCopyValue) const override
     {
-        NameProperty->SetPropertyValue(ValuePtr, FName(lua_tostring(L, IndexInStack)));
+        NameProperty->SetPropertyValue(ValuePtr, UnLua::FLuaEnv::FindEnvChecked(L).GetNameRegistry()->ToName(L, IndexInStack));
         return true;
     }
 
@@ -1209,9 +1209,11 @@ public:
 
     virtual void GetValueInternal(lua_State *L, const void *ValuePtr, bool bCreateCopy) const override
     {
+        // the class descriptor caches the metatable reference, it's gone only if the struct was unregistered
+        FClassDesc *ClassDesc = UnLua::FClassRegistry::Find(StructProperty->Struct);
         if (bCreateCopy)
         {
-            void *Userdata = NewUserdataWithPadding(L, StructSize, StructName.Get(), UserdataPadding);
+            void *Userdata = ClassDesc ? NewUserdataWithPadding(L, ClassDesc) : NewUserdataWithPadding(L, StructSize, StructName.Get(), UserdataPadding);
             StructProperty->InitializeValue(Userdata);
             StructProperty->CopySingleValue(Userdata, ValuePtr);
         }
@@ -1223,7 +1225,7 @@ public:
             }
             else
             {
-                UnLua::PushPointer(L, (void*)ValuePtr, StructName.Get(), bFirstPropOfScriptStruct);
+                UnLua::PushPointer(L, (void*)ValuePtr, StructName.Get(), ClassDesc, bFirstPropOfScriptStruct);
             }
         }
     }
@@ -13,12 +13,14 @@
 // See the License for the specific language governing permissions and limitations under the License.
 
 #include "Registries/ClassRegistry.h"
+#include "Registries/ReflectedTypeIndex.h"
 #include "LuaEnv.h"
 #include "Binding.h"
 #include "LowLevel.h"
 #include "LuaCore.h"
 #include "UELib.h"
 #include "ReflectionUtils/ClassDesc.h"
+#include "ReflectionUtils/FunctionDesc.h"
 
 extern int32 UObject_Identical(lua_State* L);
 extern int32 UObject_Delete(lua_State* L);
@@ -27,12 +29,20 @@ namespace UnLua
 {
     TMap<UStruct*, FClassDesc*> FClassRegistry::Classes;
     TMap<FName, FClassDesc*> FClassRegistry::Name2Classes;
+    FObjectIndexFilter FClassRegistry::RegisteredTypes;
 
     FClassRegistry::FClassRegistry(FLuaEnv* Env)
         : Env(Env)
     {
     }
 
+    FClassRegistry::~FClassRegistry()
+    {
+        // references are released along with the lua_State, just forget them
+        for (const auto Pair : Name2Classes)
+            Pair.Value->SetMetatableRef(Env, LUA_NOREF);
+    }
+
     TSharedPtr<FClassRegistry> FClassRegistry::Find(const lua_State* L)
     {
         const auto Env = FLuaEnv::FindEnv(L);
@@ -96,6 +106,7 @@ namespace UnLua
         if (Exists)
         {
             Classes.Add(Type, *Exists);
+            RegisteredTypes.Add(Type);
             return *Exists;
         }
 
@@ -105,9 +116,15 @@ namespace UnLua
 
     bool FClassRegistry::StaticUnregister(const UObjectBase* Type)
     {
+        const int32 Index = GUObjectArray.ObjectToIndex(Type);
+        if (!RegisteredTypes.Accept(Index))
+            return false;
+        RegisteredTypes.Remove(Index);
+
         FClassDesc* ClassDesc;
         if (!Classes.RemoveAndCopyValue((UStruct*)Type, ClassDesc))
             return false;
+        FFunctionDesc::InvalidateInterfaceFunctionCaches();
         ClassDesc->UnLoad();
         for (auto Pair : FLuaEnv::AllEnvs)
         {
@@ -165,10 +182,15 @@ namespace UnLua
             lua_pushcclosure(L, ScriptStruct_Compare, 1);
             lua_rawset(L, -4);
 
-            lua_pushstring(L, "__gc");
-            lua_pushvalue(L, -2);
-            lua_pushcclosure(L, ScriptStruct_Delete, 1);
-            lua_rawset(L, -4);
+            // POD structs (FVector, FRotator, FQuat, FTransform...) need no destruction, skipping the finalizer
+            // lets Lua free their short-lived instances in a single GC cycle without calling back into C++
+            if (!(ScriptStruct->StructFlags & (STRUCT_IsPlainOldData | STRUCT_NoDestructor)))
+            {
+                lua_pushstring(L, "__gc");
+                lua_pushvalue(L, -2);
+                lua_pushcclosure(L, ScriptStruct_Delete, 1);
+                lua_rawset(L, -4);
+            }
 
             lua_pushstring(L, "__call");
             lua_pushvalue(L, -2);
@@ -176,6 +198,14 @@ namespace UnLua
             lua_rawset(L, -4);
 
             lua_pop(L, 1);
+
+            lua_pushstring(L, "GetProperties");
+            lua_pushcfunction(L, Class_GetProperties);
+            lua_rawset(L, -3);
+
+            lua_pushstring(L, "SetProperties");
+            lua_pushcfunction(L, Class_SetProperties);
+            lua_rawset(L, -3);
         }
         else
         {
@@ -233,6 +263,32 @@ namespace UnLua
         return true;
     }
 
+    bool FClassRegistry::PushMetatable(lua_State* L, FClassDesc* ClassDesc)
+    {
+        const int32 Ref = ClassDesc->GetMetatableRef(Env);
+        if (Ref != LUA_NOREF)
+        {
+            lua_rawgeti(L, LUA_REGISTRYINDEX, Ref);
+            return true;
+        }
+
+        if (!PushMetatable(L, TCHAR_TO_UTF8(*ClassDesc->GetName())))
+            return false;
+
+        lua_pushvalue(L, -1);
+        ClassDesc->SetMetatableRef(Env, luaL_ref(L, LUA_REGISTRYINDEX));
+        return true;
+    }
+
+    bool FClassRegistry::TrySetMetatable(lua_State* L, FClassDesc* ClassDesc)
+    {
+        if (!PushMetatable(L, ClassDesc))
+            return false;
+
+        lua_setmetatable(L, -2);
+        return true;
+    }
+
     FClassDesc* FClassRegistry::Register(const char* MetatableName)
     {
         const auto L = Env->GetMainState();
@@ -257,12 +313,29 @@ namespace UnLua
             delete Pair.Value;
         Name2Classes.Empty();
         Classes.Empty();
+        RegisteredTypes.Reset();
+        FFunctionDesc::InvalidateInterfaceFunctionCaches();
+
+        for (const auto Pair : FLuaEnv::AllEnvs)
+            Pair.Value->BindDescriptors.Empty();
     }
 
     UField* FClassRegistry::LoadReflectedType(const char* InName)
     {
         FString Name = UTF8_TO_TCHAR(InName);
 
+        // only short names are indexed, path names are resolved by the engine directly
+        const bool bIndexed = Name.Len() < NAME_SIZE && !Name.Contains(TEXT("/")) && !Name.Contains(TEXT("."));
+        FName Key;
+        if (bIndexed)
+        {
+            Key = FName(*Name);
+            bool bMissed;
+            UField* Indexed = FReflectedTypeIndex::Find(Key, bMissed);
+            if (Indexed || bMissed)
+                return Indexed;
+        }
+
         // find candidates in memory
         UField* Ret = FindObject<UClass>(ANY_PACKAGE, *Name);
         if (!Ret)
@@ -278,6 +351,14 @@ namespace UnLua
         if (!Ret)
             Ret = LoadObject<UEnum>(nullptr, *Name);
 
+        if (bIndexed)
+        {
+            if (Ret)
+                FReflectedTypeIndex::Add(Key, Ret);
+            else
+                FReflectedTypeIndex::AddMissing(Key);
+        }
+
         return Ret;
     }
 
@@ -289,15 +370,23 @@ namespace UnLua
         FClassDesc* ClassDesc = new FClassDesc(Type, Name);
         Classes.Add(Type, ClassDesc);
         Name2Classes.Add(FName(*Name), ClassDesc);
+        RegisteredTypes.Add(Type);
 
         return ClassDesc;
     }
 
-    void FClassRegistry::Unregister(const FClassDesc* ClassDesc)
+    void FClassRegistry::Unregister(FClassDesc* ClassDesc)
     {
         const auto L = Env->GetMainState();
         const auto MetatableName = ClassDesc->GetName();
         lua_pushnil(L);
         lua_setfield(L, LUA_REGISTRYINDEX, TCHAR_TO_UTF8(*MetatableName));
+
+        const int32 Ref = ClassDesc->GetMetatableRef(Env);
+        if (Ref != LUA_NOREF)
+        {
+            luaL_unref(L, LUA_REGISTRYINDEX, Ref);
+            ClassDesc->SetMetatableRef(Env, LUA_NOREF);
+        }
     }
 }
@@ -16,16 +16,19 @@
 
 #include "lua.hpp"
 #include "ReflectionUtils/ClassDesc.h"
+#include "ObjectIndexFilter.h"
 
 namespace UnLua
 {
     class FLuaEnv;
 
-    class FClassRegistry
+    class UNLUA_API FClassRegistry
     {
     public:
         explicit FClassRegistry(FLuaEnv* Env);
 
+        ~FClassRegistry();
+
         static TSharedPtr<FClassRegistry> Find(const lua_State* L);
 
         static FClassDesc* Find(const char* TypeName);
@@ -46,6 +49,14 @@ namespace UnLua
 
         bool TrySetMetatable(lua_State* L, const char* MetatableName);
 
+        /**
+         * Push the metatable of a class through the registry reference cached on its descriptor,
+         * falls back to the name lookup when it's not created in this env yet
+         */
+        bool PushMetatable(lua_State* L, FClassDesc* ClassDesc);
+
+        bool TrySetMetatable(lua_State* L, FClassDesc* ClassDesc);
+
         FClassDesc* Register(const char* MetatableName);
 
         FClassDesc* Register(const UStruct* Class);
@@ -53,10 +64,11 @@ namespace UnLua
     private:
         static FClassDesc* RegisterInternal(UStruct* Type, const FString& Name);
 
-        void Unregister(const FClassDesc* ClassDesc);
+        void Unregister(FClassDesc* ClassDesc);
 
         static TMap<UStruct*, FClassDesc*> Classes;
         static TMap<FName, FClassDesc*> Name2Classes;
+        static FObjectIndexFilter RegisteredTypes;
 
         FLuaEnv* Env;
     };
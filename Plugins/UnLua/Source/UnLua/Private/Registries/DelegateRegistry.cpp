@@ -17,6 +17,11 @@
 #include "lua.hpp"
 #include "ObjectReferencer.h"
 #include "LuaEnv.h"
+#include "Misc/CoreDelegates.h"
+
+int32 GLuaDelegateHandlerPoolSize = 1024;
+
+bool GLuaBatchedBroadcast = true;
 
 namespace UnLua
 {
@@ -27,6 +32,7 @@ namespace UnLua
         {
             this->OnPostGarbageCollect();
         });
+        EndFrameHandle = FCoreDelegates::OnEndFrame.AddRaw(this, &FDelegateRegistry::OnEndFrame);
     }
 
     FDelegateRegistry::~FDelegateRegistry()
@@ -38,30 +44,181 @@ namespace UnLua
                 Env->AutoObjectReference.Remove(HandlerPair.Value.Get());
             }
         }
+        for (const auto Handler : FreeHandlers)
+            Env->AutoObjectReference.Remove(Handler);
+        for (const auto Handler : RetiredHandlers)
+            Env->AutoObjectReference.Remove(Handler);
+        FreeHandlers.Empty();
+        RetiredHandlers.Empty();
         Delegates.Empty();
+        OwnerDelegates.Empty();
+        UnownedDelegates.Empty();
         FCoreUObjectDelegates::GetPostGarbageCollect().Remove(PostGarbageCollectHandle);
+        FCoreDelegates::OnEndFrame.Remove(EndFrameHandle);
     }
 
     void FDelegateRegistry::OnPostGarbageCollect()
     {
-        TArray<TTuple<void*, FDelegateInfo>> InvalidPairs;
-        for (auto& Pair : Delegates)
+        // delegates with an owner are released by NotifyUObjectDeleted, only the unowned ones are left for GC.
+        // there is no Clear/Unbind here: without a valid owner they never touched the delegate, whose memory may
+        // be gone already, and only dropped the references to the handlers, which ReleaseHandlers does as well
+        for (const auto Delegate : UnownedDelegates)
         {
-            if (!Pair.Value.Owner.IsValid())
-                InvalidPairs.Add(Pair);
+            FDelegateInfo Info;
+            if (Delegates.RemoveAndCopyValue(Delegate, Info))
+                ReleaseHandlers(Info);
         }
+        UnownedDelegates.Empty();
+    }
+
+    void FDelegateRegistry::OnEndFrame()
+    {
+        FreeHandlers.Append(RetiredHandlers);
+        RetiredHandlers.Reset();
+    }
 
-        for (int i = 0; i < InvalidPairs.Num(); i++)
+    void FDelegateRegistry::NotifyUObjectDeleted(UObject* Object)
+    {
+        TArray<void*> OwnedDelegates;
+        if (!OwnerDelegates.RemoveAndCopyValue(Object, OwnedDelegates))
+            return;
+
+        for (const auto Delegate : OwnedDelegates)
         {
-            const auto& Pair = InvalidPairs[i];
-            if (Pair.Value.bIsMulticast)
-                Clear(Pair.Key);
-            else
-                Unbind(Pair.Key);
-            Delegates.Remove(Pair.Key);
+            // the delegate lives in the memory of the owner, so leave it untouched
+            FDelegateInfo Info;
+            if (Delegates.RemoveAndCopyValue(Delegate, Info))
+                ReleaseHandlers(Info);
         }
     }
 
+    void FDelegateRegistry::SetOwner(void* Delegate, FDelegateInfo& Info, UObject* Owner)
+    {
+        Info.Owner = Owner;
+        const auto NewOwner = Info.Owner.Get();
+        if (NewOwner == Info.IndexedOwner)
+            return;
+
+        if (Info.IndexedOwner)
+        {
+            auto& Siblings = OwnerDelegates.FindChecked(Info.IndexedOwner);
+            Siblings.RemoveSingleSwap(Delegate);
+            if (Siblings.Num() == 0)
+                OwnerDelegates.Remove(Info.IndexedOwner);
+        }
+        else
+        {
+            UnownedDelegates.Remove(Delegate);
+        }
+
+        Info.IndexedOwner = NewOwner;
+        if (NewOwner)
+        {
+            OwnerDelegates.FindOrAdd(NewOwner).Add(Delegate);
+            Env->MarkExposed(NewOwner);
+        }
+        else
+        {
+            UnownedDelegates.Add(Delegate);
+        }
+    }
+
+    void FDelegateRegistry::ReleaseHandlers(FDelegateInfo& Info)
+    {
+        if (Info.bIsMulticast)
+        {
+            ReleaseListeners(Info, false, nullptr);
+            return;
+        }
+
+        for (const auto Pair : Info.LuaFunction2Handler)
+        {
+            const auto Handler = Pair.Value;
+            if (Handler.IsValid())
+                ReleaseHandler(Handler.Get(), false);
+        }
+        Info.LuaFunction2Handler.Empty();
+    }
+
+    ULuaDelegateHandler* FDelegateRegistry::FindBatchToJoin(FDelegateInfo& Info, void* Delegate)
+    {
+        // a listener added during a broadcast gets its own handler, which is not part of the ongoing broadcast
+        if (!GLuaBatchedBroadcast || DispatchDepth > 0)
+            return nullptr;
+
+        const auto Handler = Info.LastHandler.Get();
+        if (!Handler || !Info.Listeners.Contains(Handler))
+            return nullptr;
+
+        const auto SignatureDesc = GetSignatureDesc(Delegate);
+        if (!SignatureDesc || !SignatureDesc->CanBroadcastLua())
+            return nullptr;
+
+        // only join the handler at the tail of the invocation list, so the order of other bound functions is kept
+        const auto ScriptDelegate = TMulticastDelegateTraits<FMulticastDelegateType>::GetMulticastDelegate(Info.MulticastProperty, Delegate);
+        if (!ScriptDelegate)
+            return nullptr;
+        const auto Objects = ScriptDelegate->GetAllObjects();
+        return Objects.Num() > 0 && Objects.Last() == Handler ? Handler : nullptr;
+    }
+
+    void FDelegateRegistry::ReleaseListeners(FDelegateInfo& Info, bool bDetach, void* Delegate)
+    {
+        const auto L = Env->GetMainState();
+        for (const auto& Pair : Info.Listeners)
+        {
+            for (const auto& Listener : Pair.Value)
+            {
+                luaL_unref(L, LUA_REGISTRYINDEX, Listener.LuaRef);
+                LiveListenerSerials.Remove(Listener.Serial);
+            }
+
+            const auto Handler = const_cast<ULuaDelegateHandler*>(Pair.Key);
+            if (bDetach)
+                Handler->RemoveFrom(Info.MulticastProperty, Delegate);
+            ReleaseHandler(Handler, bDetach);
+        }
+        Info.Listeners.Empty();
+        Info.LuaFunction2Handler.Empty();
+    }
+
+    ULuaDelegateHandler* FDelegateRegistry::AcquireHandler(int32 LuaRef, UObject* Owner, UObject* SelfObject)
+    {
+        if (FreeHandlers.Num() == 0)
+        {
+            const auto Handler = ULuaDelegateHandler::CreateFrom(Env, LuaRef, Owner, SelfObject);
+            Env->AutoObjectReference.Add(Handler);
+            return Handler;
+        }
+
+        const auto Handler = FreeHandlers.Pop(false);
+        Handler->LuaRef = LuaRef;
+        Handler->Owner = Owner;
+        Handler->SelfObject = SelfObject;
+        return Handler;
+    }
+
+    void FDelegateRegistry::ReleaseHandler(ULuaDelegateHandler* Handler, bool bDetached)
+    {
+        if (!bDetached || FreeHandlers.Num() + RetiredHandlers.Num() >= GLuaDelegateHandlerPoolSize)
+        {
+            Env->AutoObjectReference.Remove(Handler);
+            return;
+        }
+
+        // pooled handlers must not keep the outer of their last binding alive
+        const auto TransientPackage = GetTransientPackage();
+        if (Handler->GetOuter() != TransientPackage)
+            Handler->Rename(nullptr, TransientPackage, REN_DontCreateRedirectors | REN_ForceNoResetLoaders | REN_NonTransactional);
+
+        luaL_unref(Env->GetMainState(), LUA_REGISTRYINDEX, Handler->LuaRef);
+        Handler->LuaRef = LUA_NOREF;
+        Handler->Delegate = nullptr;
+        Handler->Owner.Reset();
+        Handler->SelfObject.Reset();
+        RetiredHandlers.Add(Handler);
+    }
+
     void FDelegateRegistry::NotifyHandlerBeginDestroy(const ULuaDelegateHandler* Handler)
     {
         const auto L = Env->GetMainState();
@@ -77,7 +234,7 @@ namespace UnLua
         if (Info)
         {
             check(Info->Property == Property);
-            Info->Owner = Owner;
+            SetOwner(Delegate, *Info, Owner);
         }
         else
         {
@@ -98,8 +255,9 @@ namespace UnLua
             {
                 check(false);
             }
-            NewInfo.Owner = Owner;
-            Delegates.Add(Delegate, NewInfo);
+            NewInfo.IndexedOwner = nullptr;
+            UnownedDelegates.Add(Delegate);
+            SetOwner(Delegate, Delegates.Add(Delegate, NewInfo), Owner);
         }
     }
 
@@ -109,7 +267,7 @@ namespace UnLua
         const auto LuaFunction = lua_topointer(L, Index);
         auto& Info = Delegates.FindChecked(Delegate);
         if (!Info.Owner.IsValid())
-            Info.Owner = SelfObject;
+            SetOwner(Delegate, Info, SelfObject);
 
         const auto LuaFunction2 = FLuaFunction2(SelfObject, LuaFunction);
         const auto Exists = Info.LuaFunction2Handler.Find(LuaFunction2);
@@ -118,9 +276,8 @@ namespace UnLua
 
         lua_pushvalue(L, Index);
         const auto Ref = luaL_ref(L, LUA_REGISTRYINDEX);
-        const auto Handler = ULuaDelegateHandler::CreateFrom(Env, Ref, Info.Owner.Get(), SelfObject);
+        const auto Handler = AcquireHandler(Ref, Info.Owner.Get(), SelfObject);
         Handler->BindTo(Delegate);
-        Env->AutoObjectReference.Add(Handler);
         Info.LuaFunction2Handler.Add(LuaFunction2, Handler);
     }
 
@@ -135,24 +292,59 @@ namespace UnLua
             const auto Handler = Pair.Value;
             if (!Handler.IsValid())
                 continue;
-            Env->AutoObjectReference.Remove(Handler.Get());
             if (Info->Owner.IsValid())
                 ((FScriptDelegate*)Delegate)->Unbind();
+            // copies of a single-cast delegate are held by value (timers, async callbacks), so the handler is never reused
+            ReleaseHandler(Handler.Get(), false);
         }
         Info->LuaFunction2Handler.Empty();
     }
 
     void FDelegateRegistry::Execute(const ULuaDelegateHandler* Handler, void* Params)
     {
+        // a retired handler is still called by broadcasts which copied the invocation list before it was removed
+        if (!Handler->Delegate)
+            return;
+
         const auto SignatureDesc = GetSignatureDesc(Handler->Delegate);
         if (!SignatureDesc)
             return;
 
-        if (Handler->SelfObject.IsStale())
+        const auto L = Env->GetMainState();
+        const auto& Info = Delegates.FindChecked(Handler->Delegate);
+        if (!Info.bIsMulticast)
+        {
+            if (Handler->SelfObject.IsStale())
+                return;
+
+            ++DispatchDepth;
+            SignatureDesc->CallLua(L, Handler->LuaRef, Params, Handler->SelfObject.Get());
+            --DispatchDepth;
+            return;
+        }
+
+        const auto Listeners = Info.Listeners.Find(Handler);
+        if (!Listeners)
             return;
 
-        const auto L = Env->GetMainState();
-        SignatureDesc->CallLua(L, Handler->LuaRef, Params, Handler->SelfObject.Get());
+        TArray<int32, TInlineAllocator<16>> LuaRefs;
+        TArray<uint32, TInlineAllocator<16>> Serials;
+        TArray<UObject*, TInlineAllocator<16>> SelfObjects;
+        for (const auto& Listener : *Listeners)
+        {
+            if (Listener.LuaFunction2.SelfObject.IsStale())
+                continue;
+            LuaRefs.Add(Listener.LuaRef);
+            Serials.Add(Listener.Serial);
+            SelfObjects.Add(Listener.LuaFunction2.SelfObject.Get());
+        }
+
+        ++DispatchDepth;
+        if (LuaRefs.Num() == 1)
+            SignatureDesc->CallLua(L, LuaRefs[0], Params, SelfObjects[0]);
+        else
+            SignatureDesc->BroadcastLua(L, LuaRefs.GetData(), Serials.GetData(), SelfObjects.GetData(), LuaRefs.Num(), Params);
+        --DispatchDepth;
     }
 
     int32 FDelegateRegistry::Execute(lua_State* L, FScriptDelegate* Delegate, int32 NumParams, int32 FirstParamIndex)
@@ -175,7 +367,7 @@ namespace UnLua
         const auto LuaFunction = lua_topointer(L, Index);
         auto& Info = Delegates.FindChecked(Delegate);
         if (!Info.Owner.IsValid())
-            Info.Owner = SelfObject;
+            SetOwner(Delegate, Info, SelfObject);
 
         const auto LuaFunction2 = FLuaFunction2(SelfObject, LuaFunction);
         const auto Exists = Info.LuaFunction2Handler.Find(LuaFunction2);
@@ -184,9 +376,16 @@ namespace UnLua
 
         lua_pushvalue(L, Index);
         const auto Ref = luaL_ref(L, LUA_REGISTRYINDEX);
-        const auto Handler = ULuaDelegateHandler::CreateFrom(Env, Ref, Info.Owner.Get(), SelfObject);
-        Env->AutoObjectReference.Add(Handler);
-        Handler->AddTo(Info.MulticastProperty, Delegate);
+        auto Handler = FindBatchToJoin(Info, Delegate);
+        if (!Handler)
+        {
+            Handler = AcquireHandler(LUA_NOREF, Info.Owner.Get(), SelfObject);
+            Handler->AddTo(Info.MulticastProperty, Delegate);
+            Info.LastHandler = Handler;
+        }
+        const uint32 Serial = ++NextListenerSerial;
+        LiveListenerSerials.Add(Serial);
+        Info.Listeners.FindOrAdd(Handler).Add({LuaFunction2, Ref, Serial});
         Info.LuaFunction2Handler.Add(LuaFunction2, Handler);
     }
 
@@ -202,8 +401,23 @@ namespace UnLua
             return;
         if (!Handler.IsValid())
             return;
+
+        if (const auto Listeners = Info.Listeners.Find(Handler.Get()))
+        {
+            const auto ListenerIndex = Listeners->IndexOfByPredicate([&](const FLuaListener& Listener) { return Listener.LuaFunction2 == LuaFunction2; });
+            if (ListenerIndex != INDEX_NONE)
+            {
+                luaL_unref(L, LUA_REGISTRYINDEX, (*Listeners)[ListenerIndex].LuaRef);
+                LiveListenerSerials.Remove((*Listeners)[ListenerIndex].Serial);
+                Listeners->RemoveAt(ListenerIndex);
+            }
+            if (Listeners->Num() > 0)
+                return;
+            Info.Listeners.Remove(Handler.Get());
+        }
+
         Handler->RemoveFrom(Info.MulticastProperty, Delegate);
-        Env->AutoObjectReference.Remove(Handler.Get());
+        ReleaseHandler(Handler.Get(), true);
     }
 
     void FDelegateRegistry::Broadcast(lua_State* L, void* Delegate, int32 NumParams, int32 FirstParamIndex)
@@ -223,16 +437,7 @@ namespace UnLua
         if (!Info)
             return;
 
-        for (const auto Pair : Info->LuaFunction2Handler)
-        {
-            const auto Handler = Pair.Value;
-            if (!Handler.IsValid())
-                continue;
-            if (Info->Owner.IsValid())
-                Handler->RemoveFrom(Info->MulticastProperty, Delegate);
-            Env->AutoObjectReference.Remove(Handler.Get());
-        }
-        Info->LuaFunction2Handler.Empty();
+        ReleaseListeners(*Info, Info->Owner.IsValid(), Delegate);
     }
 
 #pragma endregion
@@ -18,6 +18,16 @@
 #include "LuaDelegateHandler.h"
 #include "ReflectionUtils/FunctionDesc.h"
 
+/**
+ * Max number of detached multicast delegate handlers kept for reuse by each env, see UUnLuaSettings::DelegateHandlerPoolSize
+ */
+UNLUA_API extern int32 GLuaDelegateHandlerPoolSize;
+
+/**
+ * Whether Lua listeners added in a row to a multicast delegate share one handler, see UUnLuaSettings::bBatchedBroadcast
+ */
+UNLUA_API extern bool GLuaBatchedBroadcast;
+
 struct FLuaFunction2
 {
 	FLuaFunction2(TWeakObjectPtr<UObject> InSelfObject, const void* InLuaFunction)
@@ -60,6 +70,13 @@ namespace UnLua
 
         void OnPostGarbageCollect();
 
+        /**
+         * No broadcast is running at the end of a frame, so handlers released during the frame can be reused from now on
+         */
+        void OnEndFrame();
+
+        void NotifyUObjectDeleted(UObject* Object);
+
         void Register(void* Delegate, FProperty* Property, UObject* Owner);
 
         void Execute(const ULuaDelegateHandler* Handler, void* Params);
@@ -80,9 +97,26 @@ namespace UnLua
 
         void NotifyHandlerBeginDestroy(const ULuaDelegateHandler* Handler);
 
+        FORCEINLINE int32 GetNumPooledHandlers() const { return FreeHandlers.Num(); }
+
+        /**
+         * Test if a multicast listener is still added, registry references are reused so a broadcast checks the serial too
+         */
+        FORCEINLINE bool IsListenerAlive(uint32 Serial) const { return LiveListenerSerials.Contains(Serial); }
+
     private:
         TSharedPtr<FFunctionDesc> GetSignatureDesc(const void* Delegate);
 
+        /**
+         * A Lua listener of a multicast delegate
+         */
+        struct FLuaListener
+        {
+            FLuaFunction2 LuaFunction2;
+            int32 LuaRef;
+            uint32 Serial;
+        };
+
         struct FDelegateInfo
         {
             union
@@ -95,12 +129,40 @@ namespace UnLua
             UFunction* SignatureFunction;
             TSharedPtr<FFunctionDesc> Desc;
             TWeakObjectPtr<UObject> Owner;
+            UObject* IndexedOwner;
             TMap<FLuaFunction2, TWeakObjectPtr<ULuaDelegateHandler>> LuaFunction2Handler;
+            TMap<const ULuaDelegateHandler*, TArray<FLuaListener>> Listeners;   // listeners dispatched by each handler of a multicast delegate, in order
+            TWeakObjectPtr<ULuaDelegateHandler> LastHandler;
             bool bIsMulticast;
         };
 
+        void SetOwner(void* Delegate, FDelegateInfo& Info, UObject* Owner);
+
+        void ReleaseHandlers(FDelegateInfo& Info);
+
+        ULuaDelegateHandler* FindBatchToJoin(FDelegateInfo& Info, void* Delegate);
+
+        void ReleaseListeners(FDelegateInfo& Info, bool bDetach, void* Delegate);
+
+        ULuaDelegateHandler* AcquireHandler(int32 LuaRef, UObject* Owner, UObject* SelfObject);
+
+        /**
+         * Release a handler no longer tracked by any delegate info. Only handlers detached from their multicast delegate
+         * are recycled, others may still be referenced by copies of the delegate and are left to UE GC. A recycled handler
+         * is retired until the end of the frame, an ongoing broadcast may still call it through its copy of the invocation list.
+         */
+        void ReleaseHandler(ULuaDelegateHandler* Handler, bool bDetached);
+
         TMap<void*, FDelegateInfo> Delegates;
+        TMap<UObject*, TArray<void*>> OwnerDelegates;
+        TSet<void*> UnownedDelegates;
+        TArray<ULuaDelegateHandler*> FreeHandlers;
+        TArray<ULuaDelegateHandler*> RetiredHandlers;
+        TSet<uint32> LiveListenerSerials;
+        uint32 NextListenerSerial = 0;
+        int32 DispatchDepth = 0;
         FLuaEnv* Env;
         FDelegateHandle PostGarbageCollectHandle;
+        FDelegateHandle EndFrameHandle;
     };
 }
@@ -22,6 +22,7 @@ namespace UnLua
 {
     TMap<UEnum*, FEnumDesc*> FEnumRegistry::Enums;
     TMap<FName, FEnumDesc*> FEnumRegistry::Name2Enums;
+    FObjectIndexFilter FEnumRegistry::RegisteredEnums;
 
     FEnumRegistry::FEnumRegistry(FLuaEnv* Env)
         : Env(Env)
@@ -58,11 +59,17 @@ namespace UnLua
         Ret = new FEnumDesc(Enum);
         Enums.Add(Enum, Ret);
         Name2Enums.Add(MetatableName, Ret);
+        RegisteredEnums.Add(Enum);
         return Ret;
     }
 
     bool FEnumRegistry::StaticUnregister(const UObjectBase* Enum)
     {
+        const int32 Index = GUObjectArray.ObjectToIndex(Enum);
+        if (!RegisteredEnums.Accept(Index))
+            return false;
+        RegisteredEnums.Remove(Index);
+
         FEnumDesc* EnumDesc;
         if (!Enums.RemoveAndCopyValue((UEnum*)Enum, EnumDesc))
             return false;
@@ -76,6 +83,7 @@ namespace UnLua
             delete Pair.Value;
         Name2Enums.Empty();
         Enums.Empty();
+        RegisteredEnums.Reset();
     }
 
     FEnumDesc* FEnumRegistry::Register(const char* MetatableName)
@@ -16,6 +16,7 @@
 
 #include "lua.hpp"
 #include "ReflectionUtils/EnumDesc.h"
+#include "ObjectIndexFilter.h"
 
 namespace UnLua
 {
@@ -41,6 +42,7 @@ namespace UnLua
     private:
         static TMap<UEnum*, FEnumDesc*> Enums;
         static TMap<FName, FEnumDesc*> Name2Enums;
+        static FObjectIndexFilter RegisteredEnums;
         FLuaEnv* Env;
     };
 }
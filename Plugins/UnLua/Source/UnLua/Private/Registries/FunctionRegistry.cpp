@@ -22,11 +22,13 @@ namespace UnLua
 
     void FFunctionRegistry::Invoke(ULuaFunction* Function, UObject* Context, FFrame& Stack, RESULT_DECL)
     {
-        // TODO: refactor
-        if (!Env->GetObjectRegistry()->IsBound(Context))
+        const auto& ObjectRegistry = Env->GetObjectRegistry();
+        auto SelfRef = ObjectRegistry->GetBoundRef(Context);
+        if (SelfRef == LUA_NOREF)
+        {
             Env->TryBind(Context);
-
-        const auto SelfRef = Env->GetObjectRegistry()->GetBoundRef(Context);
+            SelfRef = ObjectRegistry->GetBoundRef(Context);
+        }
         check(SelfRef!=LUA_NOREF);
 
         const auto L = Env->GetMainState();
@@ -71,6 +73,7 @@ namespace UnLua
             Info.LuaRef = FuncRef;
             Info.Desc = TUniquePtr<FFunctionDesc>(FuncDesc);
             LuaFunctions.Add(Function, MoveTemp(Info));
+            Env->MarkExposed(Function);
         }
 
         if (FuncRef == LUA_NOREF)
@@ -0,0 +1,97 @@
+﻿// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+#include "Registries/NameRegistry.h"
+#include "LuaEnv.h"
+#include "UnLuaPrivate.h"
+
+namespace UnLua
+{
+    FNameRegistry::FNameRegistry(FLuaEnv* Env)
+        : StringBytes(0)
+        , NumHits(0)
+        , NumMisses(0)
+        , Env(Env)
+    {
+    }
+
+    FNameRegistry::~FNameRegistry()
+    {
+        DEC_MEMORY_STAT_BY(STAT_UnLua_NameCache_Memory, GetAllocatedSize());
+    }
+
+    void FNameRegistry::Push(lua_State* L, FName Name)
+    {
+        if (const auto Ref = Names.Find(FNameKey(Name)))
+        {
+            ++NumHits;
+            INC_DWORD_STAT(STAT_UnLua_NameCache_Hits);
+            lua_rawgeti(L, LUA_REGISTRYINDEX, *Ref);
+            return;
+        }
+
+        ++NumMisses;
+        INC_DWORD_STAT(STAT_UnLua_NameCache_Misses);
+        size_t Length;
+        lua_pushstring(L, TCHAR_TO_UTF8(*Name.ToString()));
+        const char* String = lua_tolstring(L, -1, &Length);
+        Add(L, -1, Name, String, Length);
+    }
+
+    FName FNameRegistry::ToName(lua_State* L, int32 Index)
+    {
+        if (lua_type(L, Index) != LUA_TSTRING)
+            return FName(lua_tostring(L, Index));
+
+        size_t Length;
+        const char* String = lua_tolstring(L, Index, &Length);
+        if (const auto Name = Strings.Find(String))
+        {
+            ++NumHits;
+            INC_DWORD_STAT(STAT_UnLua_NameCache_Hits);
+            return *Name;
+        }
+
+        ++NumMisses;
+        INC_DWORD_STAT(STAT_UnLua_NameCache_Misses);
+        const FName Name(String);
+        // without case preserving names the entry may be spelled differently, it must not be pushed back for this name
+        if (Name.ToString().Equals(UTF8_TO_TCHAR(String), ESearchCase::CaseSensitive))
+            Add(L, Index, Name, String, Length);
+        return Name;
+    }
+
+    void FNameRegistry::Add(lua_State* L, int32 Index, FName Name, const char* String, size_t Length)
+    {
+        if (Names.Num() >= MaxNames)
+            return;
+
+        // another string already stands for this name, e.g. one in a different case
+        const FNameKey Key(Name);
+        if (Names.Contains(Key))
+            return;
+
+        const SIZE_T OldSize = GetAllocatedSize();
+        lua_pushvalue(L, Index);
+        Names.Add(Key, luaL_ref(L, LUA_REGISTRYINDEX));
+        Strings.Add(String, Name);
+        StringBytes += Length + 1;
+        INC_MEMORY_STAT_BY(STAT_UnLua_NameCache_Memory, GetAllocatedSize() - OldSize);
+    }
+
+    SIZE_T FNameRegistry::GetAllocatedSize() const
+    {
+        return Names.GetAllocatedSize() + Strings.GetAllocatedSize() + StringBytes;
+    }
+}
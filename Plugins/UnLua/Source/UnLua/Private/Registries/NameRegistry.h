@@ -0,0 +1,89 @@
+﻿// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+#pragma once
+
+#include "lua.hpp"
+#include "UObject/NameTypes.h"
+
+namespace UnLua
+{
+    class FLuaEnv;
+
+    /**
+     * Interns FNames as Lua strings, so reading a name pushes an existing Lua string
+     * and writing back a string seen before needs no conversion.
+     */
+    class UNLUA_API FNameRegistry
+    {
+    public:
+        enum { MaxNames = 65536 };
+
+        explicit FNameRegistry(FLuaEnv* Env);
+
+        ~FNameRegistry();
+
+        void Push(lua_State* L, FName Name);
+
+        FName ToName(lua_State* L, int32 Index);
+
+        FORCEINLINE int32 Num() const { return Names.Num(); }
+
+        FORCEINLINE uint64 GetNumHits() const { return NumHits; }
+
+        FORCEINLINE uint64 GetNumMisses() const { return NumMisses; }
+
+        FORCEINLINE float GetHitRate() const { return NumHits + NumMisses > 0 ? (float)NumHits / (NumHits + NumMisses) : 0.0f; }
+
+        /**
+         * Get the memory used by the cache, including the interned Lua strings
+         */
+        SIZE_T GetAllocatedSize() const;
+
+    private:
+        /**
+         * FNames compare case-insensitive, so use the display index to keep the case the name was pushed with
+         */
+        struct FNameKey
+        {
+            explicit FNameKey(FName Name)
+                : DisplayIndex(Name.GetDisplayIndex())
+                , Number(Name.GetNumber())
+            {
+            }
+
+            FNameEntryId DisplayIndex;
+            int32 Number;
+
+            friend FORCEINLINE bool operator==(const FNameKey& A, const FNameKey& B)
+            {
+                return A.DisplayIndex == B.DisplayIndex && A.Number == B.Number;
+            }
+
+            friend FORCEINLINE uint32 GetTypeHash(const FNameKey& Key)
+            {
+                return HashCombine(GetTypeHash(Key.DisplayIndex), Key.Number);
+            }
+        };
+
+        void Add(lua_State* L, int32 Index, FName Name, const char* String, size_t Length);
+
+        TMap<FNameKey, int32> Names;                // name -> registry ref of the interned string
+        TMap<const void*, FName> Strings;           // interned string -> name, the strings are kept alive by the refs
+        SIZE_T StringBytes;
+        uint64 NumHits;
+        uint64 NumMisses;
+        FLuaEnv* Env;
+    };
+}
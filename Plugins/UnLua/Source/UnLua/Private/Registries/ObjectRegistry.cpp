@@ -20,7 +20,7 @@
 
 namespace UnLua
 {
-    static const char* ObjectMap = "ObjectMap";
+    TArray<FObjectRegistry::FBoundEnvSlot*> FObjectRegistry::BoundEnvChunks;
 
     static int ReleaseSharedPtr(lua_State* L)
     {
@@ -34,9 +34,8 @@ namespace UnLua
     {
         const auto L = Env->GetMainState();
 
-        lua_pushstring(L, ObjectMap); // create weak table 'ObjectMap'
-        LowLevel::CreateWeakValueTable(L);
-        lua_rawset(L, LUA_REGISTRYINDEX);
+        LowLevel::CreateWeakValueTable(L); // create weak table caching unbound objects by their index
+        ObjectMapRef = luaL_ref(L, LUA_REGISTRYINDEX);
 
         luaL_newmetatable(L, "TSharedPtr");
         lua_pushstring(L, "__gc");
@@ -45,6 +44,23 @@ namespace UnLua
         lua_pop(L, 1);
     }
 
+    FObjectRegistry::~FObjectRegistry()
+    {
+        for (int32 ChunkIndex = 0; ChunkIndex < Chunks.Num(); ++ChunkIndex)
+        {
+            FSlot* Chunk = Chunks[ChunkIndex];
+            if (!Chunk)
+                continue;
+
+            for (int32 i = 0; i < NumSlotsPerChunk; ++i)
+            {
+                if (Chunk[i].SerialNumber != 0 && Chunk[i].Ref != LUA_NOREF)
+                    ClearBoundEnv(ChunkIndex * NumSlotsPerChunk + i);
+            }
+            delete[] Chunk;
+        }
+    }
+
     void FObjectRegistry::NotifyUObjectDeleted(UObject* Object)
     {
         Unbind(Object);
@@ -63,40 +79,66 @@ namespace UnLua
             return;
         }
 
-        lua_getfield(L, LUA_REGISTRYINDEX, ObjectMap);
-        lua_pushlightuserdata(L, Object);
-        const auto Type = lua_rawget(L, -2);
-        if (Type == LUA_TNIL)
+        const int32 Index = GUObjectArray.ObjectToIndex(Object);
+        FSlot* Slot = FindSlot(Index);
+        if (Slot && Slot->SerialNumber != 0)
         {
-            lua_pop(L, 1);
-            PushObjectCore(L, Object);
-            lua_pushlightuserdata(L, Object);
-            lua_pushvalue(L, -2);
-            lua_rawset(L, -4);
+            if (Slot->SerialNumber != GUObjectArray.GetSerialNumber(Index))
+            {
+                ReleaseSlot(L, Index, *Slot, nullptr); // the index was reused without a delete notification
+            }
+            else if (Slot->Ref != LUA_NOREF)
+            {
+                lua_rawgeti(L, LUA_REGISTRYINDEX, Slot->Ref);
+                return;
+            }
+            else
+            {
+                lua_rawgeti(L, LUA_REGISTRYINDEX, ObjectMapRef);
+                if (lua_rawgeti(L, -1, Index) != LUA_TNIL)
+                {
+                    lua_remove(L, -2);
+                    return;
+                }
+                lua_pop(L, 2); // collected by Lua, create a new one
+            }
+        }
 
-            if (!Object->IsNative())
-                Env->AutoObjectReference.Add(Object);
+        lua_rawgeti(L, LUA_REGISTRYINDEX, ObjectMapRef);
+        PushObjectCore(L, Object);
+        lua_pushvalue(L, -1);
+        lua_rawseti(L, -3, Index);
+        lua_remove(L, -2);
 
-            ObjectRefs.Add(Object, LUA_NOREF);
+        if (!Object->IsNative())
+            Env->AutoObjectReference.Add(Object);
+
+        if (!Slot || Slot->SerialNumber == 0)
+        {
+            FSlot& NewSlot = FindOrAddSlot(Index);
+            NewSlot.SerialNumber = GUObjectArray.AllocateSerialNumber(Index);
+            NewSlot.Ref = LUA_NOREF;
+            Env->MarkExposed(Index);
         }
-        lua_remove(L, -2);
     }
 
     int FObjectRegistry::Bind(UObject* Object, const char* ModuleName)
     {
         // TODO: remove dependency of module name
-        if (const auto Exists = ObjectRefs.Find(Object))
-        {
-            if (*Exists != LUA_NOREF)
-                return *Exists;
-        }
+        const int32 Index = GUObjectArray.ObjectToIndex(Object);
+        const int32 Exists = GetBoundRef(Object);
+        if (Exists != LUA_NOREF)
+            return Exists;
 
         const auto L = Env->GetMainState();
 
+        FSlot& Slot = FindOrAddSlot(Index);
+        if (Slot.SerialNumber != 0 && Slot.SerialNumber != GUObjectArray.GetSerialNumber(Index))
+            ReleaseSlot(L, Index, Slot, nullptr); // the index was reused without a delete notification
+
         int OldTop = lua_gettop(L);
 
-        lua_getfield(L, LUA_REGISTRYINDEX, ObjectMap);
-        lua_pushlightuserdata(L, Object);
+        lua_rawgeti(L, LUA_REGISTRYINDEX, ObjectMapRef);
         lua_newtable(L); // create a Lua table ('INSTANCE')
         PushObjectCore(L, Object); // push UObject ('RAW_UOBJECT')
         lua_pushstring(L, "Object");
@@ -125,42 +167,116 @@ namespace UnLua
 
         lua_pushvalue(L, -1);
         const auto Ret = luaL_ref(L, LUA_REGISTRYINDEX);
-        ObjectRefs.Add(Object, Ret);
+        if (Slot.SerialNumber == 0)
+        {
+            Slot.SerialNumber = GUObjectArray.AllocateSerialNumber(Index);
+            Env->MarkExposed(Index);
+        }
+        Slot.Ref = Ret;
+        SetBoundEnv(Index, Slot.SerialNumber);
 
         FUnLuaDelegates::OnObjectBinded.Broadcast(Object); // 'INSTANCE' is on the top of stack now
 
-        lua_rawset(L, -3);
+        // bound objects are pushed by their references, drop the cached userdata
+        lua_pop(L, 1);
+        lua_pushnil(L);
+        lua_rawseti(L, -2, Index);
         lua_pop(L, 1);
         return Ret;
     }
 
-    bool FObjectRegistry::IsBound(const UObject* Object) const
+    int FObjectRegistry::GetBoundRef(const UObject* Object) const
     {
-        const auto Exists = ObjectRefs.Find(Object);
-        return Exists && *Exists != LUA_NOREF;
+        const int32 Index = GUObjectArray.ObjectToIndex(Object);
+        const FSlot* Slot = FindSlot(Index);
+        if (!Slot || Slot->SerialNumber == 0 || Slot->SerialNumber != GUObjectArray.GetSerialNumber(Index))
+            return LUA_NOREF;
+        return Slot->Ref;
     }
 
-    int FObjectRegistry::GetBoundRef(const UObject* Object) const
+    void FObjectRegistry::Unbind(UObject* Object)
     {
-        const auto Ref = ObjectRefs.Find(Object);
-        if (Ref)
-            return *Ref;
-        return LUA_NOREF;
+        const int32 Index = GUObjectArray.ObjectToIndex(Object);
+        FSlot* Slot = FindSlot(Index);
+        if (!Slot || Slot->SerialNumber == 0)
+            return;
+
+        ReleaseSlot(Env->GetMainState(), Index, *Slot, Object);
     }
 
-    void FObjectRegistry::Unbind(UObject* Object)
+    FLuaEnv* FObjectRegistry::FindBoundEnv(const UObject* Object)
+    {
+        const int32 Index = GUObjectArray.ObjectToIndex(Object);
+        const int32 ChunkIndex = Index / NumSlotsPerChunk;
+        if (ChunkIndex >= BoundEnvChunks.Num() || !BoundEnvChunks[ChunkIndex])
+            return nullptr;
+
+        const FBoundEnvSlot& Slot = BoundEnvChunks[ChunkIndex][Index % NumSlotsPerChunk];
+        if (Slot.SerialNumber == 0 || Slot.SerialNumber != GUObjectArray.GetSerialNumber(Index))
+            return nullptr;
+        return Slot.Env;
+    }
+
+    void FObjectRegistry::SetBoundEnv(int32 Index, int32 SerialNumber)
+    {
+        check(IsInGameThread());
+        const int32 ChunkIndex = Index / NumSlotsPerChunk;
+        if (ChunkIndex >= BoundEnvChunks.Num())
+            BoundEnvChunks.AddZeroed(ChunkIndex + 1 - BoundEnvChunks.Num());
+
+        FBoundEnvSlot*& Chunk = BoundEnvChunks[ChunkIndex];
+        if (!Chunk)
+        {
+            Chunk = new FBoundEnvSlot[NumSlotsPerChunk];
+            FMemory::Memzero(Chunk, sizeof(FBoundEnvSlot) * NumSlotsPerChunk);
+        }
+
+        FBoundEnvSlot& Slot = Chunk[Index % NumSlotsPerChunk];
+        Slot.SerialNumber = SerialNumber;
+        Slot.Env = Env;
+    }
+
+    void FObjectRegistry::ClearBoundEnv(int32 Index)
     {
-        int32 Ref;
-        if (!ObjectRefs.RemoveAndCopyValue(Object, Ref))
+        const int32 ChunkIndex = Index / NumSlotsPerChunk;
+        if (ChunkIndex >= BoundEnvChunks.Num() || !BoundEnvChunks[ChunkIndex])
             return;
 
-        RemoveFromObjectMapAndPushToStack(Object);
-        const auto L = Env->GetMainState();
+        // another env may have bound the object since
+        FBoundEnvSlot& Slot = BoundEnvChunks[ChunkIndex][Index % NumSlotsPerChunk];
+        if (Slot.Env != Env)
+            return;
+        Slot.SerialNumber = 0;
+        Slot.Env = nullptr;
+    }
+
+    FObjectRegistry::FSlot& FObjectRegistry::FindOrAddSlot(int32 Index)
+    {
+        const int32 ChunkIndex = Index / NumSlotsPerChunk;
+        if (ChunkIndex >= Chunks.Num())
+            Chunks.AddZeroed(ChunkIndex + 1 - Chunks.Num());
+
+        FSlot*& Chunk = Chunks[ChunkIndex];
+        if (!Chunk)
+        {
+            Chunk = new FSlot[NumSlotsPerChunk];
+            FMemory::Memzero(Chunk, sizeof(FSlot) * NumSlotsPerChunk);
+        }
+        return Chunk[Index % NumSlotsPerChunk];
+    }
+
+    void FObjectRegistry::ReleaseSlot(lua_State* L, int32 Index, FSlot& Slot, UObject* Object)
+    {
+        const int32 Ref = Slot.Ref;
+        Slot.SerialNumber = 0;
+        Slot.Ref = LUA_NOREF;
+
         if (Ref == LUA_NOREF)
         {
-            if (lua_isnil(L, -1))
+            lua_rawgeti(L, LUA_REGISTRYINDEX, ObjectMapRef);
+            if (lua_rawgeti(L, -1, Index) == LUA_TNIL)
             {
-                lua_pop(L, 1);
+                lua_pop(L, 2);
                 return;
             }
             check(lua_isuserdata(L, -1));
@@ -169,35 +285,23 @@ namespace UnLua
             check(bTwoLvlPtr)
             *((void**)Userdata) = (void*)LowLevel::ReleasedPtr;
             lua_pop(L, 1);
+            lua_pushnil(L);
+            lua_rawseti(L, -2, Index);
+            lua_pop(L, 1);
             return;
         }
 
+        ClearBoundEnv(Index);
+        lua_rawgeti(L, LUA_REGISTRYINDEX, Ref);
         check(lua_istable(L, -1));
         luaL_unref(L, LUA_REGISTRYINDEX, Ref);
-        FUnLuaDelegates::OnObjectUnbinded.Broadcast(Object); // object instance ('INSTANCE') is on the top of stack now
+        if (Object)
+            FUnLuaDelegates::OnObjectUnbinded.Broadcast(Object); // object instance ('INSTANCE') is on the top of stack now
 
         lua_pushstring(L, "Object");
         lua_rawget(L, -2);
         void* Userdata = lua_touserdata(L, -1);
         *((void**)Userdata) = (void*)LowLevel::ReleasedPtr;
-        lua_pop(L, 1);
-
-        // INSTANCE.Object = nil
-        lua_pushlightuserdata(L, Object);
-        lua_pushnil(L);
-        lua_rawset(L, -3);
-        lua_pop(L, 1);
-    }
-
-    void FObjectRegistry::RemoveFromObjectMapAndPushToStack(UObject* Object)
-    {
-        const auto L = Env->GetMainState();
-        lua_getfield(L, LUA_REGISTRYINDEX, ObjectMap);
-        lua_pushlightuserdata(L, Object);
-        lua_rawget(L, -2);
-        lua_pushlightuserdata(L, Object);
-        lua_pushnil(L);
-        lua_rawset(L, -4);
-        lua_remove(L, -2);
+        lua_pop(L, 2);
     }
 }
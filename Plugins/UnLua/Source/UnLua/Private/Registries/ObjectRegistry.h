@@ -24,11 +24,13 @@ namespace UnLua
 {
     class FLuaEnv;
 
-    class FObjectRegistry
+    class UNLUA_API FObjectRegistry
     {
     public:
         explicit FObjectRegistry(FLuaEnv* Env);
 
+        ~FObjectRegistry();
+
         void NotifyUObjectDeleted(UObject* Object);
 
         void NotifyUObjectLuaGC(UObject* Object);
@@ -50,7 +52,7 @@ namespace UnLua
         /**
          * 获取一个值，表示UObject是否绑定到了Lua环境。
          */
-        bool IsBound(const UObject* Object) const;
+        FORCEINLINE bool IsBound(const UObject* Object) const { return GetBoundRef(Object) != LUA_NOREF; }
 
         /**
          * 获取指定UObject在Lua里绑定的table的引用ID。
@@ -63,11 +65,57 @@ namespace UnLua
          */
         void Unbind(UObject* Object);
 
+        /**
+         * 获取绑定了指定UObject的Lua环境，解绑或环境销毁后失效。
+         * @return 若没有绑定过则返回nullptr。
+         */
+        static FLuaEnv* FindBoundEnv(const UObject* Object);
+
     private:
-        void RemoveFromObjectMapAndPushToStack(UObject* Object);
+        /**
+         * 按GUObjectArray下标存放的对象记录，序列号为0表示空槽位。
+         */
+        struct FSlot
+        {
+            int32 SerialNumber;
+            int32 Ref;
+        };
+
+        enum { NumSlotsPerChunk = 16384 };
+
+        /**
+         * 查找对象的记录，序列号不匹配（下标已被其他对象复用）时也会返回。
+         */
+        FORCEINLINE FSlot* FindSlot(int32 Index) const
+        {
+            const int32 ChunkIndex = Index / NumSlotsPerChunk;
+            if (ChunkIndex >= Chunks.Num() || !Chunks[ChunkIndex])
+                return nullptr;
+            return &Chunks[ChunkIndex][Index % NumSlotsPerChunk];
+        }
+
+        FSlot& FindOrAddSlot(int32 Index);
+
+        /**
+         * 进程内按GUObjectArray下标记录已绑定对象所在的Lua环境。
+         */
+        struct FBoundEnvSlot
+        {
+            int32 SerialNumber;
+            FLuaEnv* Env;
+        };
+
+        void SetBoundEnv(int32 Index, int32 SerialNumber);
+
+        void ClearBoundEnv(int32 Index);
+
+        static TArray<FBoundEnvSlot*> BoundEnvChunks;
+
+        void ReleaseSlot(lua_State* L, int32 Index, FSlot& Slot, UObject* Object);
 
         FLuaEnv* Env;
-        TMap<UObject*, int32> ObjectRefs;
+        TArray<FSlot*> Chunks;
+        int32 ObjectMapRef;
     };
 
     template <typename T>
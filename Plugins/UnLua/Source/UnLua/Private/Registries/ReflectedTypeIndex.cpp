@@ -0,0 +1,127 @@
+﻿// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+#include "Registries/ReflectedTypeIndex.h"
+#include "UObject/UObjectHash.h"
+
+namespace UnLua
+{
+    TMap<FName, UField*> FReflectedTypeIndex::Types;
+    TMultiMap<const UObjectBase*, FName> FReflectedTypeIndex::Names;
+    FObjectIndexFilter FReflectedTypeIndex::IndexedTypes;
+    TSet<FName> FReflectedTypeIndex::MissingNames;
+    FCriticalSection FReflectedTypeIndex::MissingNamesLock;
+    uint64 FReflectedTypeIndex::NumHits = 0;
+    uint64 FReflectedTypeIndex::NumMisses = 0;
+
+    void FReflectedTypeIndex::Build()
+    {
+        Reset();
+
+        // same priority as the lookups in FClassRegistry::LoadReflectedType, classes win over structs and enums with the same name
+        UClass* Kinds[] = {UEnum::StaticClass(), UScriptStruct::StaticClass(), UClass::StaticClass()};
+        TArray<UObject*> Objects;
+        for (UClass* Kind : Kinds)
+        {
+            Objects.Reset();
+            GetObjectsOfClass(Kind, Objects, true, RF_ClassDefaultObject);
+            for (UObject* Object : Objects)
+            {
+                if (Object->IsNative())
+                    Add(Object->GetFName(), static_cast<UField*>(Object));
+            }
+        }
+    }
+
+    void FReflectedTypeIndex::Reset()
+    {
+        Types.Empty();
+        Names.Empty();
+        IndexedTypes.Reset();
+
+        FScopeLock Lock(&MissingNamesLock);
+        MissingNames.Empty();
+    }
+
+    UField* FReflectedTypeIndex::Find(FName Name, bool& bOutMissed)
+    {
+        bOutMissed = false;
+
+        UField** Type = Types.Find(Name);
+        if (Type)
+        {
+            // types replaced by reinstancing are renamed instead of deleted
+            if ((*Type)->GetFName() == Name)
+            {
+                ++NumHits;
+                return *Type;
+            }
+            Names.RemoveSingle(*Type, Name);
+            Types.Remove(Name);
+        }
+
+        FScopeLock Lock(&MissingNamesLock);
+        bOutMissed = MissingNames.Contains(Name);
+        if (bOutMissed)
+            ++NumHits;
+        else
+            ++NumMisses;
+        return nullptr;
+    }
+
+    void FReflectedTypeIndex::Add(FName Name, UField* Type)
+    {
+        UField*& Slot = Types.FindOrAdd(Name);
+        if (Slot == Type)
+            return;
+
+        if (Slot)
+            Names.RemoveSingle(Slot, Name);
+        Slot = Type;
+        Names.Add(Type, Name);
+        IndexedTypes.Add(Type);
+    }
+
+    void FReflectedTypeIndex::AddMissing(FName Name)
+    {
+        FScopeLock Lock(&MissingNamesLock);
+        MissingNames.Add(Name);
+    }
+
+    void FReflectedTypeIndex::NotifyUObjectCreated(const UObjectBase* Object)
+    {
+        if (!Object->GetClass()->HasAnyCastFlag(CASTCLASS_UClass | CASTCLASS_UScriptStruct | CASTCLASS_UEnum))
+            return;
+
+        FScopeLock Lock(&MissingNamesLock);
+        MissingNames.Remove(Object->GetFName());
+    }
+
+    void FReflectedTypeIndex::NotifyUObjectDeleted(const UObjectBase* Object, int32 Index)
+    {
+        if (!IndexedTypes.Accept(Index))
+            return;
+        IndexedTypes.Remove(Index);
+
+        TArray<FName, TInlineAllocator<2>> TypeNames;
+        Names.MultiFind(Object, TypeNames);
+        for (const FName& Name : TypeNames)
+        {
+            UField** Type = Types.Find(Name);
+            if (Type && *Type == Object)
+                Types.Remove(Name);
+        }
+        Names.Remove(Object);
+    }
+}
@@ -0,0 +1,73 @@
+﻿// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ObjectIndexFilter.h"
+
+namespace UnLua
+{
+    /**
+     * Process-wide index of reflected types (UClass, UScriptStruct and UEnum) by name.
+     * Native types are indexed up front, others once they were found, and names that can't
+     * be found nor loaded are remembered until a type with the same name is created.
+     */
+    class UNLUA_API FReflectedTypeIndex
+    {
+    public:
+        /**
+         * Index all native types in memory
+         */
+        static void Build();
+
+        static void Reset();
+
+        /**
+         * Find a type by short name, path names are never indexed and go to FindObject/LoadObject instead
+         *
+         * @param[out] bOutMissed - whether the name is known to be missing
+         */
+        static UField* Find(FName Name, bool& bOutMissed);
+
+        static void Add(FName Name, UField* Type);
+
+        /**
+         * Remember a name that can't be found nor loaded, path names are not remembered
+         * since the creation of their types can't be told by short names
+         */
+        static void AddMissing(FName Name);
+
+        static void NotifyUObjectCreated(const UObjectBase* Object);
+
+        static void NotifyUObjectDeleted(const UObjectBase* Object, int32 Index);
+
+        FORCEINLINE static int32 Num() { return Types.Num(); }
+
+        FORCEINLINE static int32 NumMissing() { return MissingNames.Num(); }
+
+        FORCEINLINE static uint64 GetNumHits() { return NumHits; }
+
+        FORCEINLINE static uint64 GetNumMisses() { return NumMisses; }
+
+    private:
+        static TMap<FName, UField*> Types;
+        static TMultiMap<const UObjectBase*, FName> Names;   // indexed type -> names, to drop all of them on deletion
+        static FObjectIndexFilter IndexedTypes;
+        static TSet<FName> MissingNames;                      // types may be created on loading threads, guarded by MissingNamesLock
+        static FCriticalSection MissingNamesLock;
+        static uint64 NumHits;
+        static uint64 NumMisses;
+    };
+}
@@ -153,6 +153,14 @@ namespace UnLua
      * Push a pointer with the name of meta table
      */
     int32 PushPointer(lua_State *L, void *Value, const char *MetatableName, bool bAlwaysCreate)
+    {
+        return PushPointer(L, Value, MetatableName, nullptr, bAlwaysCreate);
+    }
+
+    /**
+     * Push a pointer with the class descriptor, the metatable is resolved through its cached reference
+     */
+    int32 PushPointer(lua_State *L, void *Value, const char *MetatableName, FClassDesc *ClassDesc, bool bAlwaysCreate)
     {
         if (!Value
             || !MetatableName)
@@ -176,7 +184,8 @@ namespace UnLua
                 bool bMTSame = false;
                 if (lua_getmetatable(L, -1))
                 {   
-                    luaL_getmetatable(L, MetatableName);
+                    if (!ClassDesc || !FLuaEnv::FindEnvChecked(L).GetClassRegistry()->PushMetatable(L, ClassDesc))
+                        luaL_getmetatable(L, MetatableName);
                     if (lua_rawequal(L,-1,-2))
                     {   
                         bMTSame = true;
@@ -202,7 +211,7 @@ namespace UnLua
 					UE_LOG(LogTemp, Log, TEXT("%s : userdata with difference metatable finded! need %s,get %s,may be local or stack variable pushed to lua..."),
                         ANSI_TO_TCHAR(__FUNCTION__), UTF8_TO_TCHAR(MetatableName), *CurMetatableName);
 #endif
-                    bool bSuccess = TryToSetMetatable(L, MetatableName);        // set metatable
+                    bool bSuccess = ClassDesc ? TryToSetMetatable(L, ClassDesc) : TryToSetMetatable(L, MetatableName);        // set metatable
                     if (!bSuccess)
                     {
                         UNLUA_LOGERROR(L, LogUnLua, Warning, TEXT("%s, Invalid metatable, metatable name: %s!"),  UTF8_TO_TCHAR(MetatableName));
@@ -223,7 +232,7 @@ namespace UnLua
             NewUserdataWithTwoLvPtrTag(L, sizeof(void*), Value);
             if (MetatableName)
             {
-                bool bSuccess = TryToSetMetatable(L, MetatableName);        // set metatable
+                bool bSuccess = ClassDesc ? TryToSetMetatable(L, ClassDesc) : TryToSetMetatable(L, MetatableName);        // set metatable
                 if (!bSuccess)
                 {
                     UNLUA_LOGERROR(L, LogUnLua, Warning, TEXT("%s, Invalid metatable, metatable name: %s!"), ANSI_TO_TCHAR(__FUNCTION__), UTF8_TO_TCHAR(MetatableName));
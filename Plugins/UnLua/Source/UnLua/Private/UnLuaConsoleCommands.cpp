@@ -1,4 +1,7 @@
 ﻿#include "UnLuaConsoleCommands.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "ReflectionUtils/FunctionDesc.h"
 
 #define LOCTEXT_NAMESPACE "UnLuaConsoleCommands"
 
@@ -20,6 +23,26 @@ namespace UnLua
               *LOCTEXT("CommandText_CollectGarbage", "Force collect garbage in lua env.").ToString(),
               FConsoleCommandWithArgsDelegate::CreateRaw(this, &FUnLuaConsoleCommands::CollectGarbage)
           ),
+          GCBudgetCommand(
+              TEXT("lua.gc.budget"),
+              *LOCTEXT("CommandText_GCBudget", "Set microseconds of garbage collection per frame in lua env, 0 to let lua collect on its own.").ToString(),
+              FConsoleCommandWithArgsDelegate::CreateRaw(this, &FUnLuaConsoleCommands::SetGCBudget)
+          ),
+          MemoryProfileCommand(
+              TEXT("lua.memprof"),
+              *LOCTEXT("CommandText_MemoryProfile", "Profile lua allocations by call site: start [interval] | stop | snapshot | dump [csv|json] | diff <from> <to> [csv|json].").ToString(),
+              FConsoleCommandWithArgsDelegate::CreateRaw(this, &FUnLuaConsoleCommands::ProfileMemory)
+          ),
+          CpuProfileCommand(
+              TEXT("lua.cpuprof"),
+              *LOCTEXT("CommandText_CpuProfile", "Sample lua call stacks: start [samples per second] | stop | folded | trace.").ToString(),
+              FConsoleCommandWithArgsDelegate::CreateRaw(this, &FUnLuaConsoleCommands::ProfileCpu)
+          ),
+          StatsCommand(
+              TEXT("lua.stats"),
+              *LOCTEXT("CommandText_Stats", "Count and time calls between lua and UFunctions: crossings [on | off | reset | <max rows>].").ToString(),
+              FConsoleCommandWithArgsDelegate::CreateRaw(this, &FUnLuaConsoleCommands::Stats)
+          ),
           Module(InModule)
     {
     }
@@ -79,6 +102,210 @@ namespace UnLua
 
         Env->GC();
     }
+
+    void FUnLuaConsoleCommands::SetGCBudget(const TArray<FString>& Args) const
+    {
+        auto Env = Module->GetEnv();
+        if (!Env)
+        {
+            UE_LOG(LogUnLua, Warning, TEXT("no available lua env found to set gc budget."));
+            return;
+        }
+
+        const auto GCScheduler = Env->GetGCScheduler();
+        if (Args.Num() != 1)
+        {
+            UE_LOG(LogUnLua, Log, TEXT("usage: lua.gc.budget <microseconds>, current: %d, last frame: %.3fms"), GCScheduler->GetBudget(), GCScheduler->GetLastTickTime() * 1000);
+            return;
+        }
+
+        GCScheduler->SetBudget(FCString::Atoi(*Args[0]));
+    }
+
+    void FUnLuaConsoleCommands::ProfileMemory(const TArray<FString>& Args) const
+    {
+        if (Args.Num() == 0)
+        {
+            UE_LOG(LogUnLua, Log, TEXT("usage: lua.memprof start [interval] | stop | snapshot | dump [csv|json] | diff <from> <to> [csv|json]"));
+            return;
+        }
+
+        auto Env = Module->GetEnv();
+        if (!Env)
+        {
+            UE_LOG(LogUnLua, Warning, TEXT("no available lua env found to profile memory."));
+            return;
+        }
+
+        const auto Profiler = Env->GetAllocProfiler();
+        const auto& Action = Args[0];
+        if (Action == TEXT("start"))
+        {
+            Profiler->Start(Args.Num() > 1 ? FCString::Atoi(*Args[1]) : FAllocProfiler::DefaultSampleInterval);
+            UE_LOG(LogUnLua, Log, TEXT("lua memory profiling started, sample interval: %d bytes."), Profiler->GetSampleInterval());
+            return;
+        }
+
+        if (Action == TEXT("stop"))
+        {
+            Profiler->Stop();
+            UE_LOG(LogUnLua, Log, TEXT("lua memory profiling stopped."));
+            return;
+        }
+
+        if (Action == TEXT("snapshot"))
+        {
+            UE_LOG(LogUnLua, Log, TEXT("lua memory snapshot %d taken."), Profiler->TakeSnapshot());
+            return;
+        }
+
+        TArray<FAllocProfiler::FSiteStats> Stats;
+        int32 FormatIndex;
+        if (Action == TEXT("dump"))
+        {
+            Stats = Profiler->GetLive();
+            FormatIndex = 1;
+        }
+        else if (Action == TEXT("diff") && Args.Num() > 2)
+        {
+            const int32 From = FCString::Atoi(*Args[1]);
+            const int32 To = FCString::Atoi(*Args[2]);
+            if (From < 0 || To < 0 || From >= Profiler->NumSnapshots() || To >= Profiler->NumSnapshots())
+            {
+                UE_LOG(LogUnLua, Warning, TEXT("invalid snapshots, %d taken."), Profiler->NumSnapshots());
+                return;
+            }
+            Stats = Profiler->Diff(From, To);
+            FormatIndex = 3;
+        }
+        else
+        {
+            UE_LOG(LogUnLua, Log, TEXT("usage: lua.memprof start [interval] | stop | snapshot | dump [csv|json] | diff <from> <to> [csv|json]"));
+            return;
+        }
+
+        const bool bJSON = Args.IsValidIndex(FormatIndex) && Args[FormatIndex] == TEXT("json");
+        const auto FileName = FString::Printf(TEXT("LuaMemory-%s.%s"), *FDateTime::Now().ToString(), bJSON ? TEXT("json") : TEXT("csv"));
+        const auto FilePath = FPaths::Combine(FPaths::ProfilingDir(), TEXT("UnLua"), FileName);
+        if (!FFileHelper::SaveStringToFile(bJSON ? Profiler->ToJSON(Stats) : Profiler->ToCSV(Stats), *FilePath))
+        {
+            UE_LOG(LogUnLua, Warning, TEXT("failed to save lua memory profile to %s."), *FilePath);
+            return;
+        }
+
+        for (int32 i = 0; i < FMath::Min(Stats.Num(), 10); i++)
+        {
+            const auto& Site = Profiler->GetSite(Stats[i].Site);
+            UE_LOG(LogUnLua, Log, TEXT("%10lld bytes %6lld blocks  %s (%s)"), Stats[i].Bytes, Stats[i].Count, *Site.Location, UTF8_TO_TCHAR(Site.Type));
+        }
+        UE_LOG(LogUnLua, Log, TEXT("lua memory profile saved to %s."), *FilePath);
+    }
+
+    void FUnLuaConsoleCommands::ProfileCpu(const TArray<FString>& Args) const
+    {
+        if (Args.Num() == 0)
+        {
+            UE_LOG(LogUnLua, Log, TEXT("usage: lua.cpuprof start [samples per second] | stop | folded | trace"));
+            return;
+        }
+
+        auto Env = Module->GetEnv();
+        if (!Env)
+        {
+            UE_LOG(LogUnLua, Warning, TEXT("no available lua env found to profile."));
+            return;
+        }
+
+        const auto Profiler = Env->GetCpuProfiler();
+        const auto& Action = Args[0];
+        if (Action == TEXT("start"))
+        {
+            const int32 SampleRate = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : FCpuProfiler::DefaultSampleRate;
+            if (!Profiler->Start(SampleRate))
+            {
+                UE_LOG(LogUnLua, Warning, TEXT("lua cpu profiling needs multithreading."));
+                return;
+            }
+            UE_LOG(LogUnLua, Log, TEXT("lua cpu profiling started."));
+            return;
+        }
+
+        if (Action == TEXT("stop"))
+        {
+            Profiler->Stop();
+            UE_LOG(LogUnLua, Log, TEXT("lua cpu profiling stopped, %d samples, %d late ones dropped."), Profiler->GetNumSamples(), Profiler->GetNumLateSamples());
+            return;
+        }
+
+        const bool bFolded = Action == TEXT("folded");
+        if (!bFolded && Action != TEXT("trace"))
+        {
+            UE_LOG(LogUnLua, Log, TEXT("usage: lua.cpuprof start [samples per second] | stop | folded | trace"));
+            return;
+        }
+
+        const auto FileName = FString::Printf(TEXT("LuaCpu-%s.%s"), *FDateTime::Now().ToString(), bFolded ? TEXT("folded") : TEXT("json"));
+        const auto FilePath = FPaths::Combine(FPaths::ProfilingDir(), TEXT("UnLua"), FileName);
+        if (!FFileHelper::SaveStringToFile(bFolded ? Profiler->ToFolded() : Profiler->ToChromeTrace(), *FilePath))
+        {
+            UE_LOG(LogUnLua, Warning, TEXT("failed to save lua cpu profile to %s."), *FilePath);
+            return;
+        }
+        UE_LOG(LogUnLua, Log, TEXT("lua cpu profile saved to %s."), *FilePath);
+    }
+
+    void FUnLuaConsoleCommands::Stats(const TArray<FString>& Args) const
+    {
+        if (Args.Num() == 0 || Args[0] != TEXT("crossings"))
+        {
+            UE_LOG(LogUnLua, Log, TEXT("usage: lua.stats crossings [on | off | reset | <max rows>]"));
+            return;
+        }
+
+        const FString Action = Args.Num() > 1 ? Args[1] : FString();
+        if (Action == TEXT("on") || Action == TEXT("off"))
+        {
+            GLuaCrossingStats = Action == TEXT("on");
+            UE_LOG(LogUnLua, Log, TEXT("lua crossing stats %s."), GLuaCrossingStats ? TEXT("enabled") : TEXT("disabled"));
+            return;
+        }
+
+        if (Action == TEXT("reset"))
+        {
+            FFunctionDesc::ResetCrossingStats();
+            UE_LOG(LogUnLua, Log, TEXT("lua crossing stats reset."));
+            return;
+        }
+
+        struct FRow
+        {
+            const FString* Name;
+            const TCHAR* Direction;
+            const FFunctionDesc::FCrossingStats* Stats;
+        };
+
+        TArray<FRow> Rows;
+        for (const auto& Pair : FFunctionDesc::GetCrossingRecords())
+        {
+            const FFunctionDesc::FCrossingRecord& Record = Pair.Value;
+            if (Record.LuaToUE.NumCalls)
+                Rows.Add({&Record.Name, TEXT("Lua->UE"), &Record.LuaToUE});
+            if (Record.UEToLua.NumCalls)
+                Rows.Add({&Record.Name, TEXT("UE->Lua"), &Record.UEToLua});
+        }
+        Rows.Sort([](const FRow& A, const FRow& B) { return A.Stats->InclusiveCycles > B.Stats->InclusiveCycles; });
+
+        const int32 MaxRows = Action.IsNumeric() ? FCString::Atoi(*Action) : 50;
+        UE_LOG(LogUnLua, Log, TEXT("lua crossing stats%s, %d functions:"), GLuaCrossingStats ? TEXT("") : TEXT(" (disabled)"), Rows.Num());
+        UE_LOG(LogUnLua, Log, TEXT("%12s %12s %12s %10s  %-8s %s"), TEXT("Calls"), TEXT("Total(ms)"), TEXT("Marshal(ms)"), TEXT("Avg(us)"), TEXT("Dir"), TEXT("Function"));
+        for (int32 i = 0; i < FMath::Min(Rows.Num(), MaxRows); ++i)
+        {
+            const auto& Row = Rows[i];
+            const double TotalMs = FPlatformTime::ToMilliseconds64(Row.Stats->InclusiveCycles);
+            const double MarshalMs = FPlatformTime::ToMilliseconds64(Row.Stats->MarshalCycles);
+            UE_LOG(LogUnLua, Log, TEXT("%12llu %12.3f %12.3f %10.3f  %-8s %s"), Row.Stats->NumCalls, TotalMs, MarshalMs, TotalMs * 1000 / Row.Stats->NumCalls, Row.Direction, **Row.Name);
+        }
+    }
 }
 
 #undef LOCTEXT_NAMESPACE
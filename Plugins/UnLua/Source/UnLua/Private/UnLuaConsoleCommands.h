@@ -27,6 +27,14 @@ namespace UnLua
 
         FAutoConsoleCommand CollectGarbageCommand;
 
+        FAutoConsoleCommand GCBudgetCommand;
+
+        FAutoConsoleCommand MemoryProfileCommand;
+
+        FAutoConsoleCommand CpuProfileCommand;
+
+        FAutoConsoleCommand StatsCommand;
+
         explicit FUnLuaConsoleCommands(IUnLuaModule* InModule);
 
         void Do(const TArray<FString>& Args) const;
@@ -35,6 +43,14 @@ namespace UnLua
 
         void CollectGarbage(const TArray<FString>& Args) const;
 
+        void SetGCBudget(const TArray<FString>& Args) const;
+
+        void ProfileMemory(const TArray<FString>& Args) const;
+
+        void ProfileCpu(const TArray<FString>& Args) const;
+
+        void Stats(const TArray<FString>& Args) const;
+
     private:
         IUnLuaModule* Module;
     };
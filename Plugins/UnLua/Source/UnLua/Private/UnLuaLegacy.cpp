@@ -17,8 +17,22 @@
 
 DEFINE_STAT(STAT_UnLua_Lua_Memory);
 DEFINE_STAT(STAT_UnLua_PersistentParamBuffer_Memory);
-DEFINE_STAT(STAT_UnLua_OutParmRec_Memory);
 DEFINE_STAT(STAT_UnLua_ContainerElementCache_Memory);
+DEFINE_STAT(STAT_UnLua_ParamArena_HighWaterMark_Memory);
+DEFINE_STAT(STAT_UnLua_ParamArena_FallbackAllocs);
+DEFINE_STAT(STAT_UnLua_DeleteNotify_Rejected);
+DEFINE_STAT(STAT_UnLua_DeleteNotify_Accepted);
+DEFINE_STAT(STAT_UnLua_NameCache_Hits);
+DEFINE_STAT(STAT_UnLua_NameCache_Misses);
+DEFINE_STAT(STAT_UnLua_NameCache_Memory);
+DEFINE_STAT(STAT_UnLua_LuaAllocator_Slab_Memory);
+DEFINE_STAT(STAT_UnLua_GC);
+DEFINE_STAT(STAT_UnLua_GC_Steps);
+DEFINE_STAT(STAT_UnLua_Crossings_LuaToUE_Calls);
+DEFINE_STAT(STAT_UnLua_Crossings_LuaToUE_Time);
+DEFINE_STAT(STAT_UnLua_Crossings_UEToLua_Calls);
+DEFINE_STAT(STAT_UnLua_Crossings_UEToLua_Time);
+DEFINE_STAT(STAT_UnLua_Crossings_Marshal_Time);
 
 namespace UnLua
 {
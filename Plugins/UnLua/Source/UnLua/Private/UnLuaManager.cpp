@@ -139,7 +139,8 @@ bool UUnLuaManager::Bind(UObject *Object, const TCHAR *InModuleName, int32 Initi
 
 void UUnLuaManager::OnWorldCleanup(UWorld* World, bool bArg, bool bCond)
 {
-    if (Env)
+    // spread the collection over the next frames if GC is frame budgeted
+    if (Env && !Env->GetGCScheduler()->RequestDrain())
         Env->GC();
 }
 
@@ -351,6 +352,7 @@ bool UUnLuaManager::BindInternal(UClass* Class, const FString& InModuleName, boo
 
     ModuleNames.Add(Class, RealModuleName);
     Classes.Add(RealModuleName, Class);
+    Env->MarkExposed(Class);
 
     TSet<FName> &LuaFunctions = ModuleFunctions.Add(RealModuleName);
     GetFunctionList(Env->GetMainState(), TCHAR_TO_UTF8(*RealModuleName), LuaFunctions);                         // get all functions defined in the Lua module
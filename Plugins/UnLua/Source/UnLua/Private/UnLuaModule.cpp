@@ -32,7 +32,13 @@
 #include "UnLuaSettings.h"
 #include "GameFramework/PlayerController.h"
 #include "Registries/ClassRegistry.h"
+#include "ReflectionUtils/FunctionDesc.h"
+#include "Registries/DelegateRegistry.h"
 #include "Registries/EnumRegistry.h"
+#include "Registries/ReflectedTypeIndex.h"
+#include "LuaCore.h"
+#include "LuaAllocator.h"
+#include "LuaGCScheduler.h"
 
 #define LOCTEXT_NAMESPACE "FUnLuaModule"
 
@@ -64,6 +70,7 @@ namespace UnLua
                 FEditorDelegates::PreBeginPIE.AddRaw(this, &FUnLuaModule::OnPreBeginPIE);
                 FEditorDelegates::PostPIEStarted.AddRaw(this, &FUnLuaModule::OnPostPIEStarted);
                 FEditorDelegates::EndPIE.AddRaw(this, &FUnLuaModule::OnEndPIE);
+                FCoreUObjectDelegates::OnObjectsReplaced.AddRaw(this, &FUnLuaModule::OnObjectsReplaced);
             }
 #endif
 
@@ -97,12 +104,19 @@ namespace UnLua
                 OnHandleSystemEnsureHandle = FCoreDelegates::OnHandleSystemEnsure.AddRaw(this, &FUnLuaModule::OnSystemError);
                 GUObjectArray.AddUObjectCreateListener(this);
                 GUObjectArray.AddUObjectDeleteListener(this);
+                FReflectedTypeIndex::Build();
 
                 const auto& Settings = *GetMutableDefault<UUnLuaSettings>();
                 const auto EnvLocatorClass = *Settings.EnvLocatorClass == nullptr ? ULuaEnvLocator::StaticClass() : *Settings.EnvLocatorClass;
                 EnvLocator = NewObject<ULuaEnvLocator>(GetTransientPackage(), EnvLocatorClass);
                 EnvLocator->AddToRoot();
                 FDeadLoopCheck::Timeout = Settings.DeadLoopCheck; 
+                GLuaDirectNativeCall = Settings.bDirectNativeCall;
+                GLuaDelegateHandlerPoolSize = Settings.DelegateHandlerPoolSize;
+                GLuaBatchedBroadcast = Settings.bBatchedBroadcast;
+                GLuaNativeClass = Settings.bNativeClass;
+                GLuaPooledAllocator = Settings.bPooledLuaAllocator;
+                GLuaGCBudget = Settings.GCBudgetPerFrame;
             }
             else
             {
@@ -115,6 +129,7 @@ namespace UnLua
                 EnvLocator = nullptr;
                 FClassRegistry::Cleanup();
                 FEnumRegistry::Cleanup();
+                FReflectedTypeIndex::Reset();
                 GPropertyCreator.Cleanup();
 
                 for (const auto Class : TObjectRange<UClass>())
@@ -148,6 +163,8 @@ namespace UnLua
             if (!bIsActive)
                 return;
 
+            FReflectedTypeIndex::NotifyUObjectCreated(ObjectBase);
+
             UObject* Object = (UObject*)ObjectBase;
 
             const auto Env = EnvLocator->Locate(Object);
@@ -162,6 +179,8 @@ namespace UnLua
             if (!bIsActive)
                 return;
 
+            FReflectedTypeIndex::NotifyUObjectDeleted(Object, Index);
+
             if (FClassRegistry::StaticUnregister(Object))
                 return;
 
@@ -202,6 +221,12 @@ namespace UnLua
             SetActive(false);
         }
 
+        void OnObjectsReplaced(const TMap<UObject*, UObject*>& ReplacementMap)
+        {
+            // blueprints recompiled, implementations of interface functions may have changed
+            FFunctionDesc::InvalidateInterfaceFunctionCaches();
+        }
+
 #endif
 
         void RegisterSettings()
@@ -45,8 +45,24 @@
 DECLARE_STATS_GROUP(TEXT("UnLua"), STATGROUP_UnLua, STATCAT_Advanced);
 DECLARE_MEMORY_STAT_EXTERN(TEXT("Lua Memory"), STAT_UnLua_Lua_Memory, STATGROUP_UnLua, /*UNLUA_API*/);
 DECLARE_MEMORY_STAT_EXTERN(TEXT("Persistent Parameter Buffer Memory"), STAT_UnLua_PersistentParamBuffer_Memory, STATGROUP_UnLua, /*UNLUA_API*/);
-DECLARE_MEMORY_STAT_EXTERN(TEXT("OutParmRec Memory"), STAT_UnLua_OutParmRec_Memory, STATGROUP_UnLua, /*UNLUA_API*/);
 DECLARE_MEMORY_STAT_EXTERN(TEXT("Container Element Cache Memory"), STAT_UnLua_ContainerElementCache_Memory, STATGROUP_UnLua, /*UNLUA_API*/);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Param Arena High Water Mark"), STAT_UnLua_ParamArena_HighWaterMark_Memory, STATGROUP_UnLua, /*UNLUA_API*/);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Param Arena Fallback Allocations"), STAT_UnLua_ParamArena_FallbackAllocs, STATGROUP_UnLua, /*UNLUA_API*/);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Delete Notifications Rejected"), STAT_UnLua_DeleteNotify_Rejected, STATGROUP_UnLua, /*UNLUA_API*/);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Delete Notifications Accepted"), STAT_UnLua_DeleteNotify_Accepted, STATGROUP_UnLua, /*UNLUA_API*/);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Name Cache Hits"), STAT_UnLua_NameCache_Hits, STATGROUP_UnLua, /*UNLUA_API*/);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Name Cache Misses"), STAT_UnLua_NameCache_Misses, STATGROUP_UnLua, /*UNLUA_API*/);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Name Cache Memory"), STAT_UnLua_NameCache_Memory, STATGROUP_UnLua, /*UNLUA_API*/);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Lua Allocator Slab Memory"), STAT_UnLua_LuaAllocator_Slab_Memory, STATGROUP_UnLua, /*UNLUA_API*/);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Lua GC"), STAT_UnLua_GC, STATGROUP_UnLua, /*UNLUA_API*/);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Lua GC Steps"), STAT_UnLua_GC_Steps, STATGROUP_UnLua, /*UNLUA_API*/);
+
+DECLARE_STATS_GROUP(TEXT("UnLua Crossings"), STATGROUP_UnLuaCrossings, STATCAT_Advanced);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Lua To UE Calls"), STAT_UnLua_Crossings_LuaToUE_Calls, STATGROUP_UnLuaCrossings, /*UNLUA_API*/);
+DECLARE_FLOAT_COUNTER_STAT_EXTERN(TEXT("Lua To UE Time (ms)"), STAT_UnLua_Crossings_LuaToUE_Time, STATGROUP_UnLuaCrossings, /*UNLUA_API*/);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("UE To Lua Calls"), STAT_UnLua_Crossings_UEToLua_Calls, STATGROUP_UnLuaCrossings, /*UNLUA_API*/);
+DECLARE_FLOAT_COUNTER_STAT_EXTERN(TEXT("UE To Lua Time (ms)"), STAT_UnLua_Crossings_UEToLua_Time, STATGROUP_UnLuaCrossings, /*UNLUA_API*/);
+DECLARE_FLOAT_COUNTER_STAT_EXTERN(TEXT("Marshal Time (ms)"), STAT_UnLua_Crossings_Marshal_Time, STATGROUP_UnLuaCrossings, /*UNLUA_API*/);
 
 #define UNLUA_STAT_MEMORY_ALLOC(Pointer, CounterName) \
     const auto _AllocedSize = FMemory::GetAllocSize(Pointer); \
@@ -21,11 +21,19 @@
 #include "Registries/FunctionRegistry.h"
 #include "Registries/ContainerRegistry.h"
 #include "Registries/EnumRegistry.h"
+#include "Registries/NameRegistry.h"
 #include "UnLuaManager.h"
 #include "lua.hpp"
 #include "ObjectReferencer.h"
 #include "HAL/Platform.h"
+#include "Containers/Queue.h"
 #include "LuaDeadLoopCheck.h"
+#include "ParamArena.h"
+#include "LuaAllocator.h"
+#include "LuaGCScheduler.h"
+#include "LuaAllocProfiler.h"
+#include "LuaCpuProfiler.h"
+#include "ObjectIndexFilter.h"
 
 namespace UnLua
 {
@@ -48,9 +56,23 @@ namespace UnLua
 
         virtual ~FLuaEnv() override;
 
-        static FLuaEnv* FindEnv(const lua_State* L);
+        /**
+         * the env pointer is stored in the extra space of the main thread, and copied to every thread created from it.
+         * luai_userstateopen zeroes the extra space, so states not created by an env get nullptr
+         */
+        FORCEINLINE static FLuaEnv* FindEnv(const lua_State* L)
+        {
+            if (!L)
+                return nullptr;
+            return *(FLuaEnv**)lua_getextraspace(const_cast<lua_State*>(L));
+        }
 
-        static FLuaEnv& FindEnvChecked(const lua_State* L);
+        FORCEINLINE static FLuaEnv& FindEnvChecked(const lua_State* L)
+        {
+            FLuaEnv* Env = FindEnv(L);
+            check(Env);
+            return *Env;
+        }
 
         const FString& GetName();
 
@@ -64,6 +86,10 @@ namespace UnLua
 
         virtual bool TryReplaceInputs(UObject* Object);
 
+        void SetBindCacheEnabled(bool bEnabled);
+
+        FORCEINLINE bool IsBindCacheEnabled() const { return bBindCacheEnabled; }
+
         bool DoString(const FString& Chunk, const FString& ChunkName = "chunk");
 
         bool LoadString(const TArray<uint8>& Chunk, const FString& ChunkName = "chunk")
@@ -106,8 +132,30 @@ namespace UnLua
 
         FORCEINLINE TSharedPtr<FEnumRegistry> GetEnumRegistry() const { return EnumRegistry; }
 
+        FORCEINLINE TSharedPtr<FNameRegistry> GetNameRegistry() const { return NameRegistry; }
+
         FORCEINLINE TSharedPtr<FDeadLoopCheck> GetDeadLoopCheck() const { return DeadLoopCheck; }
 
+        FORCEINLINE TSharedPtr<FGCScheduler> GetGCScheduler() const { return GCScheduler; }
+
+        FORCEINLINE TSharedPtr<FAllocProfiler> GetAllocProfiler() const { return AllocProfiler; }
+
+        FORCEINLINE TSharedPtr<FCpuProfiler> GetCpuProfiler() const { return CpuProfiler; }
+
+        FORCEINLINE FParamArena& GetParamArena() { return ParamArena; }
+
+        /** the pooled allocator of the Lua state, null if the env doesn't use one */
+        FORCEINLINE const FLuaAllocator* GetAllocator() const { return Allocator.Get(); }
+
+        /**
+         * Mark an object as held by this env, so its deletion will be dispatched to the registries
+         */
+        FORCEINLINE void MarkExposed(const UObjectBase* Object) { ExposedObjects.Add(Object); }
+
+        FORCEINLINE void MarkExposed(int32 ObjectIndex) { ExposedObjects.Add(ObjectIndex); }
+
+        FORCEINLINE const FObjectIndexFilter& GetDeleteFilter() const { return ExposedObjects; }
+
         void AddLoader(const FLuaFileLoader Loader);
 
         void AddBuiltInLoader(const FString InName, lua_CFunction Loader);
@@ -136,13 +184,24 @@ namespace UnLua
 
         void RegisterDelegates();
 
+        struct FBindDescriptor
+        {
+            FString ModuleName;
+            bool bFiltered = false;
+            bool bImplUnluaInterface = false;
+        };
+
+        bool ResolveBindDescriptor(UObject* Object, FBindDescriptor& Descriptor) const;
+
         void UnRegisterDelegates();
 
         static TMap<lua_State*, FLuaEnv*> AllEnvs;
         TMap<FString, lua_CFunction> BuiltinLoaders;
         TArray<FLuaFileLoader> CustomLoaders;
-        TArray<FWeakObjectPtr> Candidates; // binding candidates during async loading
-        FCriticalSection CandidatesLock;
+        TQueue<FWeakObjectPtr, EQueueMode::Mpsc> Candidates; // binding candidates from loading threads, drained on the game thread
+        TArray<FWeakObjectPtr> DeferredCandidates; // game thread only, drained candidates still being loaded
+        TMap<UClass*, FBindDescriptor> BindDescriptors; // per-class bind decisions, invalidated when the class is deleted
+        bool bBindCacheEnabled = true;
         FObjectReferencer AutoObjectReference;
         FObjectReferencer ManualObjectReference;
         UUnLuaManager* Manager = nullptr;
@@ -152,7 +211,14 @@ namespace UnLua
         TSharedPtr<FFunctionRegistry> FunctionRegistry;
         TSharedPtr<FContainerRegistry> ContainerRegistry;
         TSharedPtr<FEnumRegistry> EnumRegistry;
+        TSharedPtr<FNameRegistry> NameRegistry;
         TSharedPtr<FDeadLoopCheck> DeadLoopCheck;
+        TSharedPtr<FGCScheduler> GCScheduler;
+        TSharedPtr<FAllocProfiler> AllocProfiler;
+        TSharedPtr<FCpuProfiler> CpuProfiler;
+        FParamArena ParamArena;
+        TUniquePtr<FLuaAllocator> Allocator;
+        FObjectIndexFilter ExposedObjects;
         TMap<lua_State*, int32> ThreadToRef;
         TMap<int32, lua_State*> RefToThread;
         FDelegateHandle OnAsyncLoadingFlushUpdateHandle;
@@ -715,6 +715,7 @@ namespace UnLua
         int32 MessageHandlerIdx = lua_gettop(L) - 1;
         check(MessageHandlerIdx > 0);
         int32 NumArgs = PushArgs<false>(L, Forward<T>(Args)...);
+        const FParamArena::FScope ParamScope(Env->GetParamArena());
         int32 Code = lua_pcall(L, NumArgs, LUA_MULTRET, MessageHandlerIdx);
         int32 TopIdx = lua_gettop(L);
         if (Code == LUA_OK)
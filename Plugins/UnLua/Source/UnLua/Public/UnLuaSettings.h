@@ -34,4 +34,28 @@ public:
     /** Class of LuaEnvLocator, which handles lua env locating for each UObject. */
     UPROPERTY(Config, EditAnywhere, Category="Runtime", Meta=(AllowAbstract="false"))
     TSubclassOf<ULuaEnvLocator> EnvLocatorClass = ULuaEnvLocator::StaticClass();
+
+    /** Call native non-RPC UFunctions through their thunks directly instead of UObject::ProcessEvent. */
+    UPROPERTY(Config, EditAnywhere, Category="Runtime")
+    bool bDirectNativeCall = true;
+
+    /** Max number of multicast delegate handlers kept by each lua env for reuse after their listeners are removed, 0 to disable pooling. */
+    UPROPERTY(Config, EditAnywhere, Category="Runtime", Meta=(ClampMin="0"))
+    int32 DelegateHandlerPoolSize = 1024;
+
+    /** Dispatch Lua listeners added in a row to a multicast delegate in one batch, with parameters pushed to Lua only once. */
+    UPROPERTY(Config, EditAnywhere, Category="Runtime")
+    bool bBatchedBroadcast = true;
+
+    /** Create Lua classes with a native 'Class', whose member lookups don't run Lua code. The stock UnLua.lua keeps it when required, a customized UnLua.lua still defines its own. */
+    UPROPERTY(Config, EditAnywhere, Category="Runtime")
+    bool bNativeClass = true;
+
+    /** Allocate small Lua objects from size class pools of each env instead of forwarding every allocation to the engine allocator. */
+    UPROPERTY(Config, EditAnywhere, Category="Runtime")
+    bool bPooledLuaAllocator = false;
+
+    /** Microseconds of Lua GC work per frame, done incrementally at the end of each frame. 0 to let Lua collect garbage on its own. */
+    UPROPERTY(Config, EditAnywhere, Category="Runtime", meta=(ClampMin="0"))
+    int32 GCBudgetPerFrame = 0;
 };
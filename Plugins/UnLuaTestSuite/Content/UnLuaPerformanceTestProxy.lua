@@ -200,6 +200,42 @@ function UnLuaPerformanceTestProxy:ReceiveBeginPlay()
 	EndTime = Seconds()
 	Message = Message .. "\n" .. "FHitResult() ; "..tostring((EndTime - StartTime) * Multiplier)
 
+	local LargeN = 10000000
+	StartTime = Seconds()
+	for i=1, LargeN do
+		local MeshID = RawObject.MeshID
+	end
+	EndTime = Seconds()
+	Message = Message .. "\n" .. "read int32 x10M ; "..tostring((EndTime - StartTime) * 1000000000.0 / LargeN)
+
+	local bDirectNativeCall = SetDirectNativeCall(true)
+	for _, bDirect in ipairs({false, true}) do
+		SetDirectNativeCall(bDirect)
+		local Path = bDirect and "direct" or "ProcessEvent"
+
+		StartTime = Seconds()
+		for i=1, N do
+			self:NOP()
+		end
+		EndTime = Seconds()
+		Message = Message .. "\n" .. "void NOP() [" .. Path .. "] ; "..tostring((EndTime - StartTime) * Multiplier)
+
+		StartTime = Seconds()
+		for i=1, N do
+			local NewMeshID = self:UpdateMeshID(1024)
+		end
+		EndTime = Seconds()
+		Message = Message .. "\n" .. "int32 UpdateMeshID(int32) [" .. Path .. "] ; "..tostring((EndTime - StartTime) * Multiplier)
+
+		StartTime = Seconds()
+		for i=1, N do
+			local bHit = self:Raycast(Origin, Direction)
+		end
+		EndTime = Seconds()
+		Message = Message .. "\n" .. "bool Raycast(const FVector&, const FVector&) const [" .. Path .. "] ; "..tostring((EndTime - StartTime) * Multiplier)
+	end
+	SetDirectNativeCall(bDirectNativeCall)
+
 	LogPerformanceData(Message)
 end
 
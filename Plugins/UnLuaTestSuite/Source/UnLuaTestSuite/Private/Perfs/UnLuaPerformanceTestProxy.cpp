@@ -84,6 +84,7 @@ bool AUnLuaPerformanceTestProxy::GetMeshInfo(int32 &OutMeshID, FString &OutMeshN
 #include "Misc/DateTime.h"
 #include "Misc/FileHelper.h"
 #include "UnLuaEx.h"
+#include "ReflectionUtils/FunctionDesc.h"
 
 bool LogPerformanceData(const FString &Message)
 {
@@ -96,4 +97,13 @@ EXPORT_FUNCTION(bool, LogPerformanceData, const FString&)
 
 EXPORT_FUNCTION_EX(Seconds, double, FPlatformTime::Seconds)
 
+bool SetDirectNativeCall(bool bEnable)
+{
+    const bool bWasEnabled = GLuaDirectNativeCall;
+    GLuaDirectNativeCall = bEnable;
+    return bWasEnabled;
+}
+
+EXPORT_FUNCTION(bool, SetDirectNativeCall, bool)
+
 #endif
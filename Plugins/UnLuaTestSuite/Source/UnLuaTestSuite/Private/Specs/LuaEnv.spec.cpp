@@ -16,6 +16,9 @@
 #include "UnLuaTemplate.h"
 #include "UnLuaTestHelpers.h"
 #include "Misc/AutomationTest.h"
+#include "Misc/CoreDelegates.h"
+#include "Engine/World.h"
+#include "Async/Async.h"
 
 #if WITH_DEV_AUTOMATION_TESTS
 
@@ -47,6 +50,608 @@ void FLuaEnvSpec::Define()
             TEST_EQUAL(A, 1);
             TEST_EQUAL(B, 2);
         });
+
+        It(TEXT("查找Lua状态所属的环境"), EAsyncExecution::TaskGraphMainThread, [this]()
+        {
+            const auto L = Env->GetMainState();
+            TEST_EQUAL(UnLua::FLuaEnv::FindEnv(L), Env.Get());
+            TEST_EQUAL(UnLua::FLuaEnv::FindEnv(lua_newthread(L)), Env.Get());
+            lua_pop(L, 1);
+
+            // a state not created by an env
+            const auto Other = luaL_newstate();
+            TEST_NULL(UnLua::FLuaEnv::FindEnv(Other));
+            TEST_NULL(UnLua::FLuaEnv::FindEnv(lua_newthread(Other)));
+            lua_close(Other);
+        });
+    });
+
+    Describe(TEXT("绑定决策缓存"), [this]()
+    {
+        It(TEXT("对象创建吞吐量（开启/关闭缓存）"), EAsyncExecution::TaskGraphMainThread, [this]()
+        {
+            constexpr int32 N = 100000;
+            const auto Measure = [this](bool bCacheEnabled)
+            {
+                Env->SetBindCacheEnabled(bCacheEnabled);
+                const auto StartTime = FPlatformTime::Seconds();
+                for (int32 i = 0; i < N; i++)
+                {
+                    const auto Object = NewObject<UUnLuaTestStub>();
+                    Env->TryBind(Object);
+                }
+                return FPlatformTime::Seconds() - StartTime;
+            };
+
+            const auto Uncached = Measure(false);
+            const auto Cached = Measure(true);
+            AddInfo(FString::Printf(TEXT("create %d objects, without cache: %.3fms, with cache: %.3fms"), N, Uncached * 1000, Cached * 1000));
+
+            TEST_TRUE(Env->IsBindCacheEnabled());
+            TEST_FALSE(Env->TryBind(NewObject<UUnLuaTestStub>()));
+            CollectGarbage(RF_NoFlags, true);
+        });
+    });
+
+    Describe(TEXT("对象注册表"), [this]()
+    {
+        It(TEXT("重复压栈得到同一个userdata"), EAsyncExecution::TaskGraphMainThread, [this]()
+        {
+            const auto L = Env->GetMainState();
+            const auto Object = NewObject<UUnLuaTestStub>();
+            UnLua::PushUObject(L, Object);
+            UnLua::PushUObject(L, Object);
+            TEST_TRUE(lua_rawequal(L, -1, -2) == 1);
+            lua_pop(L, 2);
+        });
+
+        It(TEXT("记录绑定对象所在的Lua环境"), EAsyncExecution::TaskGraphMainThread, [this]()
+        {
+            const auto Object = NewObject<UUnLuaTestBindingStub>();
+            TEST_NULL(UnLua::FObjectRegistry::FindBoundEnv(Object));
+
+            Env->TryBind(Object);
+            TEST_EQUAL(UnLua::FObjectRegistry::FindBoundEnv(Object), Env.Get());
+
+            Env->GetObjectRegistry()->Unbind(Object);
+            TEST_NULL(UnLua::FObjectRegistry::FindBoundEnv(Object));
+
+            Env->TryBind(Object);
+            Env.Reset();
+            TEST_NULL(UnLua::FObjectRegistry::FindBoundEnv(Object));
+        });
+
+        It(TEXT("压栈吞吐量（不同对象/重复对象）"), EAsyncExecution::TaskGraphMainThread, [this]()
+        {
+            constexpr int32 N = 1000000;
+            const auto L = Env->GetMainState();
+
+            TArray<UObject*> Objects;
+            Objects.Reserve(N);
+            for (int32 i = 0; i < N; i++)
+                Objects.Add(NewObject<UUnLuaTestInterfaceImplA>());
+
+            auto StartTime = FPlatformTime::Seconds();
+            for (const auto Object : Objects)
+            {
+                UnLua::PushUObject(L, Object);
+                lua_pop(L, 1);
+            }
+            const auto Distinct = FPlatformTime::Seconds() - StartTime;
+
+            StartTime = FPlatformTime::Seconds();
+            for (int32 i = 0; i < N; i++)
+            {
+                UnLua::PushUObject(L, Objects[i % 64]);
+                lua_pop(L, 1);
+            }
+            const auto Repeated = FPlatformTime::Seconds() - StartTime;
+            AddInfo(FString::Printf(TEXT("push %d objects, distinct: %.3fms, repeated: %.3fms"), N, Distinct * 1000, Repeated * 1000));
+
+            Env.Reset();
+            Objects.Empty();
+            CollectGarbage(RF_NoFlags, true);
+        });
+    });
+
+    Describe(TEXT("名字缓存"), [this]()
+    {
+        It(TEXT("重复读写FName属性不再转换字符串"), EAsyncExecution::TaskGraphMainThread, [this]()
+        {
+            const auto L = Env->GetMainState();
+            const auto Stub = NewObject<UUnLuaTestStub>();
+            Stub->TestName = TEXT("UnLuaTestName");
+            UnLua::PushUObject(L, Stub);
+            lua_setglobal(L, "Stub");
+
+            const auto Registry = Env->GetNameRegistry();
+            Env->DoString("local Name = Stub.TestName; Stub.TestName = Name");
+            const auto NumMisses = Registry->GetNumMisses();
+
+            const char* Chunk = R"(
+            for i = 1, 10000 do
+                local Name = Stub.TestName
+                Stub.TestName = Name
+            end
+            Result = Stub.TestName
+            )";
+            Env->DoString(Chunk);
+
+            TEST_EQUAL(Registry->GetNumMisses(), NumMisses);
+            TEST_TRUE(Registry->GetHitRate() > 0.99f);
+            lua_getglobal(L, "Result");
+            TEST_EQUAL(FString(lua_tostring(L, -1)), TEXT("UnLuaTestName"));
+            TEST_EQUAL(Stub->TestName, FName(TEXT("UnLuaTestName")));
+            AddInfo(FString::Printf(TEXT("%d names, hit rate %.4f, %llu bytes"), Registry->Num(), Registry->GetHitRate(), (uint64)Registry->GetAllocatedSize()));
+        });
+
+        It(TEXT("读取FName得到其自身的拼写而非写入时的大小写"), EAsyncExecution::TaskGraphMainThread, [this]()
+        {
+            const auto L = Env->GetMainState();
+            const auto Stub = NewObject<UUnLuaTestStub>();
+            Stub->TestName = TEXT("UnLuaCaseTestName");
+            UnLua::PushUObject(L, Stub);
+            lua_setglobal(L, "Stub");
+
+            Env->DoString("Stub.TestName = 'unluacasetestname'; Result = Stub.TestName");
+            lua_getglobal(L, "Result");
+            TEST_EQUAL(FString(lua_tostring(L, -1)), Stub->TestName.ToString());
+        });
+    });
+
+    Describe(TEXT("元表引用缓存"), [this]()
+    {
+        It(TEXT("类描述缓存元表引用"), EAsyncExecution::TaskGraphMainThread, [this]()
+        {
+            const auto L = Env->GetMainState();
+            const auto Stub = NewObject<UUnLuaTestStub>();
+            UnLua::PushUObject(L, Stub);
+
+            const auto ClassDesc = UnLua::FClassRegistry::Find(UUnLuaTestStub::StaticClass());
+            TEST_TRUE(ClassDesc != nullptr);
+            const int32 Ref = ClassDesc->GetMetatableRef(Env.Get());
+            TEST_TRUE(Ref != LUA_NOREF);
+
+            lua_getmetatable(L, -1);
+            lua_rawgeti(L, LUA_REGISTRYINDEX, Ref);
+            luaL_getmetatable(L, TCHAR_TO_UTF8(*ClassDesc->GetName()));
+            TEST_TRUE(lua_rawequal(L, -1, -2));
+            TEST_TRUE(lua_rawequal(L, -1, -3));
+            lua_pop(L, 4);
+
+            const auto Env2 = MakeShared<UnLua::FLuaEnv>();
+            UnLua::PushUObject(Env2->GetMainState(), Stub);
+            TEST_TRUE(ClassDesc->GetMetatableRef(Env2.Get()) != LUA_NOREF);
+
+            const UnLua::FLuaEnv* Released = Env.Get();
+            Env.Reset();
+            TEST_EQUAL(ClassDesc->GetMetatableRef(Released), LUA_NOREF);
+            TEST_TRUE(ClassDesc->GetMetatableRef(Env2.Get()) != LUA_NOREF);
+        });
+
+        It(TEXT("结构体创建吞吐量"), EAsyncExecution::TaskGraphMainThread, [this]()
+        {
+            const char* Chunk = R"(
+            local FUnLuaTestTableRow = UE.FUnLuaTestTableRow
+            local StartTime = os.clock()
+            for i = 1, 1000000 do
+                local Row = FUnLuaTestTableRow()
+            end
+            Result = (os.clock() - StartTime) * 1000
+            )";
+            TEST_TRUE(Env->DoString(Chunk));
+
+            const auto L = Env->GetMainState();
+            lua_getglobal(L, "Result");
+            AddInfo(FString::Printf(TEXT("create 1000000 structs: %.3fms"), lua_tonumber(L, -1)));
+            lua_pop(L, 1);
+        });
+    });
+
+    Describe(TEXT("原生Class"), [this]()
+    {
+        const char* Setup = R"(
+            -- the Class defined by Content/Script/UnLua.lua, which keeps a native one that is already there
+            NativeClass = Class
+            Class = nil
+            package.loaded["UnLua"] = nil
+            require("UnLua")
+            LuaClass = Class
+            Class = NativeClass
+
+            -- bind the same way as FObjectRegistry::Bind
+            function BindStub(Module)
+                setmetatable(Module, getmetatable(Stub))
+                return setmetatable({ Object = Stub }, Module)
+            end
+        )";
+
+        BeforeEach([this, Setup]
+        {
+            const auto Stub = NewObject<UUnLuaTestStub>();
+            UnLua::PushUObject(Env->GetMainState(), Stub);
+            lua_setglobal(Env->GetMainState(), "Stub");
+            Env->DoString(Setup);
+        });
+
+        It(TEXT("不阻止加载项目自定义的UnLua.lua"), EAsyncExecution::TaskGraphMainThread, [this]()
+        {
+            UnLua::FLuaEnv NewEnv;
+            NewEnv.DoString("Result = package.loaded['UnLua'] == nil");
+            lua_getglobal(NewEnv.GetMainState(), "Result");
+            TEST_TRUE(!!lua_toboolean(NewEnv.GetMainState(), -1));
+
+            Env->DoString(R"(
+            package.loaded["UnLua"] = nil
+            require("UnLua")
+            Result = Class == NativeClass and LuaClass ~= NativeClass
+            )");
+            const auto L = Env->GetMainState();
+            lua_getglobal(L, "Result");
+            TEST_TRUE(!!lua_toboolean(L, -1));
+        });
+
+        It(TEXT("与UnLua.lua行为一致"), EAsyncExecution::TaskGraphMainThread, [this]()
+        {
+            const char* Chunk = R"(
+            local Results = {}
+            for _, Factory in ipairs({ Class, LuaClass }) do
+                local Base = Factory()
+                function Base:Foo() return "Base" end
+                package.loaded["UnLuaTestNativeClassBase"] = Base
+
+                local Module = Factory("UnLuaTestNativeClassBase")
+                local Instance = BindStub(Module)
+                Instance.Counter = 5
+                Instance.LuaField = 1
+                table.insert(Results, table.concat({
+                    tostring(Module.Super == Base),
+                    Instance:Foo(),
+                    tostring(rawget(Instance, "Foo") ~= nil),
+                    tostring(Instance.Counter),
+                    tostring(rawget(Instance, "Counter")),
+                    tostring(Instance.LuaField),
+                    tostring(Instance.NotExists),
+                    tostring(rawget(Module, "NotExists") ~= nil),
+                }, ","))
+            end
+            package.loaded["UnLuaTestNativeClassBase"] = nil
+            return Results[1], Results[2]
+            )";
+            Env->DoString(Chunk);
+
+            const auto L = Env->GetMainState();
+            const FString Native = UTF8_TO_TCHAR(lua_tostring(L, -2));
+            const FString Script = UTF8_TO_TCHAR(lua_tostring(L, -1));
+            TEST_EQUAL(Native, TEXT("true,Base,true,5,nil,1,nil,true"));
+            TEST_EQUAL(Native, Script);
+        });
+
+        It(TEXT("属性读写吞吐量（原生/UnLua.lua）"), EAsyncExecution::TaskGraphMainThread, [this]()
+        {
+            const char* Chunk = R"(
+            local function Run(Factory)
+                local Instance = BindStub(Factory())
+                local StartTime = os.clock()
+                for i = 1, 1000000 do
+                    Instance.Counter = Instance.Counter + 1
+                end
+                return (os.clock() - StartTime) * 1000
+            end
+            return Run(Class), Run(LuaClass)
+            )";
+            Env->DoString(Chunk);
+
+            const auto L = Env->GetMainState();
+            AddInfo(FString::Printf(TEXT("1000000 property reads and writes, native: %.3fms, UnLua.lua: %.3fms"), lua_tonumber(L, -2), lua_tonumber(L, -1)));
+        });
+    });
+
+    Describe(TEXT("池化分配器"), [this]()
+    {
+        It(TEXT("统计每个尺寸档位的存活与峰值数量"), EAsyncExecution::TaskGraphMainThread, [this]()
+        {
+            TGuardValue<bool> PooledAllocator(GLuaPooledAllocator, true);
+            Env = MakeShared<UnLua::FLuaEnv>();
+            const auto Allocator = Env->GetAllocator();
+            TEST_TRUE(Allocator != nullptr);
+
+            Env->DoString("Tables = {} for i = 1, 1000 do Tables[i] = {} end");
+            int32 NumLive = 0;
+            for (int32 i = 0; i < UnLua::FLuaAllocator::NumSizeClasses; i++)
+            {
+                const auto& Stats = Allocator->GetStats(i);
+                TEST_TRUE(Stats.NumPeak >= Stats.NumLive);
+                NumLive += Stats.NumLive;
+            }
+            TEST_TRUE(NumLive > 1000);
+
+            Env->DoString("Tables = nil collectgarbage('collect')");
+            int32 NumLiveAfterGC = 0;
+            for (int32 i = 0; i < UnLua::FLuaAllocator::NumSizeClasses; i++)
+                NumLiveAfterGC += Allocator->GetStats(i).NumLive;
+            TEST_TRUE(NumLiveAfterGC < NumLive - 1000);
+        });
+
+        It(TEXT("分配密集脚本的吞吐量与内存占用（默认/池化）"), EAsyncExecution::TaskGraphMainThread, [this]()
+        {
+            const char* Chunk = R"(
+                local Clock = os.clock
+                local Start = Clock()
+                for i = 1, 1000000 do
+                    local t = { i, i + 1, x = i }
+                end
+                local TableChurn = Clock() - Start
+                Start = Clock()
+                local s
+                for i = 1, 200000 do
+                    s = "key_" .. i .. "_" .. (i * 2)
+                end
+                return TableChurn, Clock() - Start
+            )";
+
+            const auto Measure = [&](bool bPooled, double& OutTableChurn, double& OutConcat, int64& OutUsedPhysical)
+            {
+                TGuardValue<bool> PooledAllocator(GLuaPooledAllocator, bPooled);
+                Env = MakeShared<UnLua::FLuaEnv>();
+                const auto UsedPhysical = (int64)FPlatformMemory::GetStats().UsedPhysical;
+                Env->DoString(Chunk);
+                const auto L = Env->GetMainState();
+                OutTableChurn = lua_tonumber(L, -2);
+                OutConcat = lua_tonumber(L, -1);
+                OutUsedPhysical = (int64)FPlatformMemory::GetStats().UsedPhysical - UsedPhysical;
+                Env.Reset();
+            };
+
+            double DefaultTables, DefaultConcat, PooledTables, PooledConcat;
+            int64 DefaultRSS, PooledRSS;
+            Measure(false, DefaultTables, DefaultConcat, DefaultRSS);
+            Measure(true, PooledTables, PooledConcat, PooledRSS);
+            AddInfo(FString::Printf(TEXT("1M tables, default: %.3fms, pooled: %.3fms; 200K concats, default: %.3fms, pooled: %.3fms; RSS growth, default: %lldKB, pooled: %lldKB"),
+                DefaultTables * 1000, PooledTables * 1000, DefaultConcat * 1000, PooledConcat * 1000, DefaultRSS / 1024, PooledRSS / 1024));
+        });
+    });
+
+    Describe(TEXT("参数内存"), [this]()
+    {
+        It(TEXT("调用中抛出Lua错误后参数内存回到调用前的位置"), EAsyncExecution::TaskGraphMainThread, [this]()
+        {
+            // the error of a bad argument longjmps past the param scope of the call, like CallUE does
+            const auto L = Env->GetMainState();
+            lua_pushcfunction(L, [](lua_State* InL) -> int
+            {
+                UnLua::FParamArena::FScope ParamScope(UnLua::FLuaEnv::FindEnvChecked(InL).GetParamArena());
+                ParamScope.Alloc(64);
+                return luaL_argerror(InL, 1, "bad argument");
+            });
+            lua_setglobal(L, "RaiseInParamScope");
+            const auto& Arena = Env->GetParamArena();
+
+            Env->DoString("assert(not pcall(RaiseInParamScope)) assert(not pcall(RaiseInParamScope))");
+            TEST_EQUAL(Arena.GetUsedSize(), 0);
+
+            AddExpectedError(TEXT("bad argument"), EAutomationExpectedErrorFlags::Contains, 0);
+            TEST_FALSE(Env->DoString("RaiseInParamScope()"));
+            TEST_EQUAL(Arena.GetUsedSize(), 0);
+            TEST_EQUAL(Arena.GetNumFallbackAllocs(), 0);
+        });
+    });
+
+    Describe(TEXT("分帧GC"), [this]()
+    {
+        It(TEXT("按帧预算逐步回收垃圾"), EAsyncExecution::TaskGraphMainThread, [this]()
+        {
+            const auto L = Env->GetMainState();
+            const auto GCScheduler = Env->GetGCScheduler();
+            GCScheduler->SetBudget(500);
+
+            Env->DoString("Garbage = {} for i = 1, 200000 do Garbage[i] = { i } end Garbage = nil");
+            const auto CountBefore = lua_gc(L, LUA_GCCOUNT, 0);
+            TEST_TRUE(GCScheduler->RequestDrain());
+
+            int32 NumTicks = 0;
+            double MaxTickTime = 0;
+            while (GCScheduler->IsDraining() && NumTicks < 100000)
+            {
+                GCScheduler->Tick();
+                MaxTickTime = FMath::Max(MaxTickTime, GCScheduler->GetLastTickTime());
+                NumTicks++;
+            }
+            TEST_FALSE(GCScheduler->IsDraining());
+            TEST_TRUE(lua_gc(L, LUA_GCCOUNT, 0) < CountBefore / 2);
+
+            Env->DoString("Garbage = {} for i = 1, 200000 do Garbage[i] = { i } end Garbage = nil");
+            const auto StartTime = FPlatformTime::Seconds();
+            Env->GC();
+            const auto FullGCTime = FPlatformTime::Seconds() - StartTime;
+
+            GCScheduler->SetBudget(0);
+            AddInfo(FString::Printf(TEXT("drain %dKB in %d ticks, max tick: %.3fms, full collection: %.3fms"), CountBefore, NumTicks, MaxTickTime * 1000, FullGCTime * 1000));
+        });
+
+        It(TEXT("关闭预算时恢复自动GC"), EAsyncExecution::TaskGraphMainThread, [this]()
+        {
+            const auto L = Env->GetMainState();
+            const auto GCScheduler = Env->GetGCScheduler();
+            GCScheduler->SetBudget(500);
+            TEST_FALSE((bool)lua_gc(L, LUA_GCISRUNNING, 0));
+            GCScheduler->SetBudget(0);
+            TEST_TRUE((bool)lua_gc(L, LUA_GCISRUNNING, 0));
+            TEST_FALSE(GCScheduler->RequestDrain());
+        });
+
+        It(TEXT("世界清理后紧接着的UE GC能回收只被Lua引用的对象"), EAsyncExecution::TaskGraphMainThread, [this]()
+        {
+            const auto L = Env->GetMainState();
+            const auto GCScheduler = Env->GetGCScheduler();
+            GCScheduler->SetBudget(500);
+            Env->GetManager();
+
+            TWeakObjectPtr<UUnLuaTestStub> Stub = NewObject<UUnLuaTestStub>();
+            UnLua::PushUObject(L, Stub.Get());
+            lua_setglobal(L, "Stub");
+            Env->DoString("Stub = nil");
+
+            FWorldDelegates::OnWorldCleanup.Broadcast(nullptr, true, true);
+            TEST_TRUE(GCScheduler->IsDraining());
+            CollectGarbage(RF_NoFlags, true);
+            TEST_FALSE(GCScheduler->IsDraining());
+            TEST_FALSE(Stub.IsValid());
+
+            GCScheduler->SetBudget(0);
+        });
+
+#if 504 == LUA_VERSION_NUM
+        It(TEXT("关闭预算时恢复原有的GC模式"), EAsyncExecution::TaskGraphMainThread, [this]()
+        {
+            const auto L = Env->GetMainState();
+            const auto GCScheduler = Env->GetGCScheduler();
+            lua_gc(L, LUA_GCINC, 150, 300, 0);
+            GCScheduler->SetBudget(500);
+            GCScheduler->SetBudget(0);
+            TEST_EQUAL(lua_gc(L, LUA_GCGEN, 0, 0), LUA_GCINC);
+
+            GCScheduler->SetBudget(500);
+            GCScheduler->SetBudget(0);
+            TEST_EQUAL(lua_gc(L, LUA_GCINC, 0, 0, 0), LUA_GCGEN);
+
+            lua_gc(L, LUA_GCSTOP, 0);
+            GCScheduler->SetBudget(500);
+            GCScheduler->SetBudget(0);
+            TEST_FALSE((bool)lua_gc(L, LUA_GCISRUNNING, 0));
+        });
+#endif
+    });
+
+    Describe(TEXT("内存分配分析"), [this]()
+    {
+        It(TEXT("按调用位置统计快照间的内存增长"), EAsyncExecution::TaskGraphMainThread, [this]()
+        {
+            const auto L = Env->GetMainState();
+            const auto Profiler = Env->GetAllocProfiler();
+            void* UserData;
+            const auto Alloc = lua_getallocf(L, &UserData);
+
+            Profiler->Start(1);
+            TEST_TRUE(lua_getallocf(L, nullptr) != Alloc);
+            const auto From = Profiler->TakeSnapshot();
+            Env->DoString("Retained = {}\nfor i = 1, 1000 do\nRetained[i] = {}\nend");
+            const auto To = Profiler->TakeSnapshot();
+
+            const auto Diff = Profiler->Diff(From, To);
+            TEST_TRUE(Diff.Num() > 0);
+            const auto& Top = Profiler->GetSite(Diff[0].Site);
+            TEST_TRUE(Top.Location.EndsWith(TEXT(":3")));
+            TEST_EQUAL(FString(Top.Type), FString(TEXT("table")));
+            TEST_EQUAL(Diff[0].Count, (int64)1000);
+            TEST_TRUE(Profiler->ToCSV(Diff).Contains(Top.Location));
+            TEST_TRUE(Profiler->ToJSON(Diff).Contains(TEXT("\"type\": \"table\"")));
+
+            Env->DoString("Retained = nil collectgarbage('collect')");
+            const auto Collected = Profiler->Diff(To, Profiler->TakeSnapshot());
+            TEST_TRUE(Collected.Num() > 0 && Collected.Last().Count <= -1000);
+
+            Profiler->Stop();
+            TEST_TRUE(lua_getallocf(L, nullptr) == Alloc);
+        });
+    });
+
+    Describe(TEXT("CPU采样"), [this]()
+    {
+        It(TEXT("采样Lua调用栈并导出折叠栈与Chrome trace"), EAsyncExecution::TaskGraphMainThread, [this]()
+        {
+            const auto Profiler = Env->GetCpuProfiler();
+            if (!Profiler->Start(1000))
+                return;
+
+            Env->DoString(R"(
+                function Busy()
+                    local Start = os.clock()
+                    while os.clock() - Start < 0.2 do end
+                end
+                Busy()
+            )");
+            Profiler->Stop();
+            TEST_FALSE(Profiler->IsRunning());
+            TEST_TRUE(lua_gethook(Env->GetMainState()) == nullptr);
+            TEST_TRUE(Profiler->GetNumSamples() > 0);
+
+            const auto Folded = Profiler->ToFolded();
+            TEST_TRUE(Folded.Contains(TEXT(";Busy (")));
+            const auto Trace = Profiler->ToChromeTrace();
+            TEST_TRUE(Trace.StartsWith(TEXT("{\"traceEvents\"")));
+            TEST_TRUE(Trace.Contains(TEXT("\"ph\": \"B\"")));
+            AddInfo(FString::Printf(TEXT("%d samples in 200ms at 1000Hz"), Profiler->GetNumSamples()));
+        });
+
+        It(TEXT("丢弃Lua空闲时挂起到下次进入Lua才触发的采样"), EAsyncExecution::TaskGraphMainThread, [this]()
+        {
+            const auto Profiler = Env->GetCpuProfiler();
+            if (!Profiler->Start(1000))
+                return;
+
+            FPlatformProcess::Sleep(0.05f);
+            Env->DoString("local a = 1");
+            Profiler->Stop();
+            TEST_EQUAL(Profiler->GetNumSamples(), 0);
+            TEST_TRUE(Profiler->GetNumLateSamples() > 0);
+        });
+    });
+
+    Describe(TEXT("异步加载绑定"), [this]()
+    {
+        It(TEXT("加载线程并发提交大量绑定候选"), EAsyncExecution::TaskGraphMainThread, [this]()
+        {
+            constexpr int32 N = 50000;
+            constexpr int32 NumProducers = 4;
+            const auto L = Env->GetMainState();
+
+            TArray<UObject*> Objects;
+            Objects.Reserve(N);
+            for (int32 i = 0; i < N; i++)
+            {
+                const auto Object = NewObject<UUnLuaTestBindingStub>();
+                if (i % 2)
+                    Object->SetFlags(RF_NeedPostLoad); // not loaded yet, binding should be deferred
+                Objects.Add(Object);
+            }
+
+            auto StartTime = FPlatformTime::Seconds();
+            TArray<TFuture<void>> Producers;
+            for (int32 Producer = 0; Producer < NumProducers; Producer++)
+            {
+                Producers.Add(Async(EAsyncExecution::ThreadPool, [this, &Objects, Producer]
+                {
+                    for (int32 i = Producer; i < Objects.Num(); i += NumProducers)
+                        Env->TryBind(Objects[i]);
+                }));
+            }
+            for (auto& Producer : Producers)
+                Producer.Wait();
+            const auto Enqueue = FPlatformTime::Seconds() - StartTime;
+
+            StartTime = FPlatformTime::Seconds();
+            FCoreDelegates::OnAsyncLoadingFlushUpdate.Broadcast();
+            const auto Drain = FPlatformTime::Seconds() - StartTime;
+
+            lua_getglobal(L, "NumBound");
+            TEST_EQUAL(lua_tointeger(L, -1), (lua_Integer)N / 2);
+            lua_pop(L, 1);
+
+            for (const auto Object : Objects)
+                Object->ClearFlags(RF_NeedPostLoad);
+            FCoreDelegates::OnAsyncLoadingFlushUpdate.Broadcast();
+
+            lua_getglobal(L, "NumBound");
+            TEST_EQUAL(lua_tointeger(L, -1), (lua_Integer)N);
+            lua_pop(L, 1);
+
+            AddInfo(FString::Printf(TEXT("%d candidates from %d threads, enqueue: %.3fms, first flush: %.3fms"), N, NumProducers, Enqueue * 1000, Drain * 1000));
+
+            Env.Reset();
+            Objects.Empty();
+            CollectGarbage(RF_NoFlags, true);
+        });
     });
 
     AfterEach([this]
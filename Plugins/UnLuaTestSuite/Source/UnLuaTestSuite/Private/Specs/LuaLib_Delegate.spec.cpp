@@ -84,6 +84,23 @@ void FUnLuaLibDelegateSpec::Define()
             Env->DoString(Chunk);
             TEST_FALSE(Stub->SimpleHandler.IsBound());
         });
+
+        It(TEXT("解绑后委托的拷贝不会调用新绑定的函数"), EAsyncExecution::TaskGraphMainThread, [this]()
+        {
+            Env->DoString("Stub.SimpleHandler:Bind(Stub, function() end)");
+            const FUnLuaTestSimpleHandler Copy = Stub->SimpleHandler;
+
+            const auto Chunk = R"(
+            NewCalls = 0
+            Stub.SimpleHandler:Unbind()
+            Stub.SimpleHandler:Bind(Stub, function() NewCalls = NewCalls + 1 end)
+            )";
+            Env->DoString(Chunk);
+            Copy.ExecuteIfBound();
+
+            lua_getglobal(L, "NewCalls");
+            TEST_EQUAL(lua_tointeger(L, -1), 0LL);
+        });
     });
 
     Describe(TEXT("Execute"), [this]()
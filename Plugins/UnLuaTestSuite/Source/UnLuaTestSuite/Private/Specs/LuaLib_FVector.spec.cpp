@@ -19,6 +19,24 @@
 
 #if WITH_DEV_AUTOMATION_TESTS
 
+namespace
+{
+    struct FCountingAllocator
+    {
+        lua_Alloc Alloc;
+        void* UserData;
+        int64 NumAllocs;
+    };
+
+    void* CountingAlloc(void* UserData, void* Ptr, size_t OldSize, size_t NewSize)
+    {
+        FCountingAllocator* Allocator = (FCountingAllocator*)UserData;
+        if (!Ptr && NewSize > 0)
+            Allocator->NumAllocs++;
+        return Allocator->Alloc(Allocator->UserData, Ptr, OldSize, NewSize);
+    }
+}
+
 BEGIN_DEFINE_SPEC(FUnLuaLibFVectorSpec, "UnLua.API.FVector", EAutomationTestFlags::ProductFilter | EAutomationTestFlags::ApplicationContextMask)
     lua_State* L;
 END_DEFINE_SPEC(FUnLuaLibFVectorSpec)
@@ -139,6 +157,56 @@ void FUnLuaLibFVectorSpec::Define()
             const auto& Vector = UnLua::Get<FVector>(L, -1, UnLua::TType<FVector>());
             TEST_EQUAL(Vector, FVector(1.1f,2.2f,3.3f) + FVector(4.4f,5.5f,6.6f));
         });
+
+        It(TEXT("结果写入指定向量"), EAsyncExecution::TaskGraphMainThread, [this]()
+        {
+            const char* Chunk = "\
+            local Vector1 = UE.FVector(1.1,2.2,3.3)\
+            local Vector2 = UE.FVector(4.4,5.5,6.6)\
+            local Out = UE.FVector()\
+            return Vector1:Add(Vector2, Out) == Out, Vector1, Out\
+            ";
+            UnLua::RunChunk(L, Chunk);
+            TEST_TRUE(lua_toboolean(L, -3));
+            TEST_EQUAL(UnLua::Get<FVector>(L, -2, UnLua::TType<FVector>()), FVector(1.1f,2.2f,3.3f));
+            TEST_EQUAL(UnLua::Get<FVector>(L, -1, UnLua::TType<FVector>()), FVector(1.1f,2.2f,3.3f) + FVector(4.4f,5.5f,6.6f));
+        });
+
+        It(TEXT("每百万次运算的分配次数与GC耗时"), EAsyncExecution::TaskGraphMainThread, [this]()
+        {
+            FCountingAllocator Allocator;
+            Allocator.Alloc = lua_getallocf(L, &Allocator.UserData);
+            Allocator.NumAllocs = 0;
+            lua_setallocf(L, CountingAlloc, &Allocator);
+
+            const auto Measure = [&](const char* Chunk, int64& OutNumAllocs, double& OutGCTime)
+            {
+                UnLua::RunChunk(L, "collectgarbage('collect'); collectgarbage('stop')");
+                Allocator.NumAllocs = 0;
+                UnLua::RunChunk(L, Chunk);
+                OutNumAllocs = Allocator.NumAllocs;
+
+                const auto StartTime = FPlatformTime::Seconds();
+                UnLua::RunChunk(L, "collectgarbage('collect'); collectgarbage('restart')");
+                OutGCTime = FPlatformTime::Seconds() - StartTime;
+            };
+
+            int64 OperatorAllocs, ScratchAllocs;
+            double OperatorGCTime, ScratchGCTime;
+            Measure("\
+            local A, B = UE.FVector(1,2,3), UE.FVector(4,5,6)\
+            for i = 1, 1000000 do local C = A + B end\
+            ", OperatorAllocs, OperatorGCTime);
+            Measure("\
+            local A, B, Out = UE.FVector(1,2,3), UE.FVector(4,5,6), UE.FVector()\
+            for i = 1, 1000000 do A:Add(B, Out) end\
+            ", ScratchAllocs, ScratchGCTime);
+
+            lua_setallocf(L, Allocator.Alloc, Allocator.UserData);
+            TEST_TRUE(ScratchAllocs < OperatorAllocs);
+            AddInfo(FString::Printf(TEXT("1M FVector additions, operator: %lld allocations, GC %.3fms; output parameter: %lld allocations, GC %.3fms"),
+                OperatorAllocs, OperatorGCTime * 1000, ScratchAllocs, ScratchGCTime * 1000));
+        });
     });
 
     Describe(TEXT("Sub"), [this]
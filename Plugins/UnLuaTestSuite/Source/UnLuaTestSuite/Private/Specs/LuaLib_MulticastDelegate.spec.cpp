@@ -16,6 +16,9 @@
 #include "UnLuaTemplate.h"
 #include "Misc/AutomationTest.h"
 #include "UnLuaTestHelpers.h"
+#include "LuaDelegateHandler.h"
+#include "LuaEnv.h"
+#include "Misc/CoreDelegates.h"
 
 #if WITH_DEV_AUTOMATION_TESTS
 
@@ -130,6 +133,252 @@ void FUnLuaLibMulticastDelegateSpec::Define()
         });
     });
 
+    Describe(TEXT("批量广播"), [this]()
+    {
+        It(TEXT("保持与其他绑定之间的顺序"), EAsyncExecution::TaskGraphMainThread, [this]()
+        {
+            const char* Chunk = R"(
+            Order = ""
+            Stub.SimpleEvent:Add(Stub, function() Order = Order .. "1" end)
+            Stub.SimpleEvent:Add(Stub, function() Order = Order .. "2" end)
+            )";
+            UnLua::RunChunk(L, Chunk);
+
+            FScriptDelegate NativeDelegate;
+            NativeDelegate.BindUFunction(Stub, TEXT("AddCount"));
+            Stub->SimpleEvent.Add(NativeDelegate);
+
+            UnLua::RunChunk(L, "Stub.SimpleEvent:Add(Stub, function() Order = Order .. Stub.Counter end)");
+            TEST_EQUAL(Stub->SimpleEvent.GetAllObjects().Num(), 3);
+
+            Stub->SimpleEvent.Broadcast();
+            lua_getglobal(L, "Order");
+            TEST_EQUAL(FString(lua_tostring(L, -1)), TEXT("121"));
+        });
+
+        It(TEXT("广播过程中移除和添加监听"), EAsyncExecution::TaskGraphMainThread, [this]()
+        {
+            const char* Chunk = R"(
+            Order = ""
+            local Second = function() Order = Order .. "2" end
+            local Third = function() Order = Order .. "3" end
+            Stub.SimpleEvent:Add(Stub, function()
+                Order = Order .. "1"
+                Stub.SimpleEvent:Remove(Stub, Second)
+                Stub.SimpleEvent:Add(Stub, Third)
+            end)
+            Stub.SimpleEvent:Add(Stub, Second)
+            )";
+            UnLua::RunChunk(L, Chunk);
+            Stub->SimpleEvent.Broadcast();
+            lua_getglobal(L, "Order");
+            TEST_EQUAL(FString(lua_tostring(L, -1)), TEXT("1"));
+
+            Stub->SimpleEvent.Broadcast();
+            lua_getglobal(L, "Order");
+            TEST_EQUAL(FString(lua_tostring(L, -1)), TEXT("113"));
+        });
+
+        It(TEXT("广播过程中移除后重新添加同一函数"), EAsyncExecution::TaskGraphMainThread, [this]()
+        {
+            const char* Chunk = R"(
+            Order = ""
+            local Second = function() Order = Order .. "2" end
+            Stub.SimpleEvent:Add(Stub, function()
+                Order = Order .. "1"
+                Stub.SimpleEvent:Remove(Stub, Second)
+                Stub.SimpleEvent:Add(Stub, Second)
+            end)
+            Stub.SimpleEvent:Add(Stub, Second)
+            )";
+            UnLua::RunChunk(L, Chunk);
+            Stub->SimpleEvent.Broadcast();
+            lua_getglobal(L, "Order");
+            TEST_EQUAL(FString(lua_tostring(L, -1)), TEXT("1"));
+        });
+
+        It(TEXT("大量Lua监听"), EAsyncExecution::TaskGraphMainThread, [this]()
+        {
+            const char* Chunk = R"(
+            Sum = 0
+            for i = 1, 200 do
+                Stub.PayloadEvent:Add(Stub, function(Self, Value, Location) Sum = Sum + Value + Location.X end)
+            end
+            )";
+
+            const auto Run = [&](bool bBatched, const TCHAR* Label)
+            {
+                const auto SavedBatched = GLuaBatchedBroadcast;
+                GLuaBatchedBroadcast = bBatched;
+                UnLua::RunChunk(L, "Stub.PayloadEvent:Clear()");
+                UnLua::RunChunk(L, Chunk);
+                GLuaBatchedBroadcast = SavedBatched;
+
+                const auto StartTime = FPlatformTime::Seconds();
+                for (auto i = 0; i < 1000; i++)
+                    Stub->PayloadEvent.Broadcast(1, FVector(1, 2, 3));
+                const auto Duration = (FPlatformTime::Seconds() - StartTime) * 1000;
+                AddInfo(FString::Printf(TEXT("%s: %d handlers, %.3fms"), Label, Stub->PayloadEvent.GetAllObjects().Num(), Duration));
+
+                lua_getglobal(L, "Sum");
+                TEST_EQUAL(lua_tointeger(L, -1), 400000LL);
+                lua_pop(L, 1);
+            };
+
+            Run(false, TEXT("one handler per listener"));
+            Run(true, TEXT("batched"));
+        });
+    });
+
+    Describe(TEXT("Owner"), [this]()
+    {
+        It(TEXT("Owner销毁时释放Lua绑定"), EAsyncExecution::TaskGraphMainThread, [this]()
+        {
+            const auto CountHandlers = []
+            {
+                int32 Count = 0;
+                for (TObjectIterator<ULuaDelegateHandler> It; It; ++It)
+                {
+                    if (!It->HasAnyFlags(RF_ClassDefaultObject))
+                        Count++;
+                }
+                return Count;
+            };
+
+            constexpr auto NumOwners = 1000;
+            TArray<UUnLuaTestStub*> Owners;
+            for (auto i = 0; i < NumOwners; i++)
+            {
+                const auto Owner = NewObject<UUnLuaTestStub>();
+                UnLua::PushUObject(L, Owner);
+                lua_setglobal(L, "Owner");
+                UnLua::RunChunk(L, "Owner.SimpleEvent:Add(Owner, function() end); Owner = nil");
+                Owners.Add(Owner);
+            }
+
+            const auto NumBefore = CountHandlers();
+            TEST_TRUE(NumBefore >= NumOwners);
+
+            for (const auto Owner : Owners)
+                Owner->MarkPendingKill();
+            CollectGarbage(RF_NoFlags, true);
+            CollectGarbage(RF_NoFlags, true);
+
+            TEST_EQUAL(CountHandlers(), NumBefore - NumOwners);
+        });
+    });
+
+    Describe(TEXT("Handler复用"), [this]()
+    {
+        It(TEXT("移除后的Handler被复用且不再调用旧函数"), EAsyncExecution::TaskGraphMainThread, [this]()
+        {
+            const char* Chunk = R"(
+            Old, New = 0, 0
+            local OldCallback = function() Old = Old + 1 end
+            Stub.SimpleEvent:Add(Stub, OldCallback)
+            Stub.SimpleEvent:Remove(Stub, OldCallback)
+            Stub.SimpleEvent:Add(Stub, function() New = New + 1 end)
+            )";
+            const auto Registry = UnLua::FLuaEnv::FindEnvChecked(L).GetDelegateRegistry();
+            UnLua::RunChunk(L, Chunk);
+            TEST_EQUAL(Registry->GetNumPooledHandlers(), 0);
+            Stub->SimpleEvent.Broadcast();
+            lua_getglobal(L, "Old");
+            TEST_EQUAL(lua_tointeger(L, -1), 0LL);
+            lua_getglobal(L, "New");
+            TEST_EQUAL(lua_tointeger(L, -1), 1LL);
+
+            FCoreDelegates::OnEndFrame.Broadcast();
+            TEST_EQUAL(Registry->GetNumPooledHandlers(), 1);
+            UnLua::RunChunk(L, "Stub.PayloadEvent:Add(Stub, function() end)");
+            TEST_EQUAL(Registry->GetNumPooledHandlers(), 0);
+        });
+
+        It(TEXT("原生监听者在广播中绑定其他委托时不复用同一广播中移除的Handler"), EAsyncExecution::TaskGraphMainThread, [this]()
+        {
+            const char* Chunk = R"(
+            Removed, Payload = 0, 0
+            local Second = function() Removed = Removed + 1 end
+            Stub.SimpleEvent:Add(Stub, function() Stub.SimpleEvent:Remove(Stub, Second) end)
+            )";
+            UnLua::RunChunk(L, Chunk);
+
+            // native listeners don't dispatch through the registry, so the handler of Second is released while the
+            // broadcast still holds it in its copy of the invocation list
+            FScriptDelegate NativeListener;
+            NativeListener.BindUFunction(Stub, TEXT("NativeListener"));
+            Stub->SimpleEvent.Add(NativeListener);
+            Stub->NativeListenerCallback = [this]
+            {
+                UnLua::RunChunk(L, "Stub.PayloadEvent:Add(Stub, function(Self, Value, Location) Payload = Payload + Value end)");
+            };
+            UnLua::RunChunk(L, "Stub.SimpleEvent:Add(Stub, Second)");
+
+            Stub->SimpleEvent.Broadcast();
+            Stub->NativeListenerCallback = nullptr;
+            lua_getglobal(L, "Removed");
+            TEST_EQUAL(lua_tointeger(L, -1), 0LL);
+            lua_getglobal(L, "Payload");
+            TEST_EQUAL(lua_tointeger(L, -1), 0LL);
+
+            Stub->PayloadEvent.Broadcast(2, FVector::ZeroVector);
+            lua_getglobal(L, "Payload");
+            TEST_EQUAL(lua_tointeger(L, -1), 2LL);
+        });
+
+        It(TEXT("界面频繁绑定解绑"), EAsyncExecution::TaskGraphMainThread, [this]()
+        {
+            constexpr auto NumWidgets = 200;
+            lua_newtable(L);
+            for (auto i = 1; i <= NumWidgets; i++)
+            {
+                UnLua::PushUObject(L, NewObject<UUnLuaTestStub>());
+                lua_rawseti(L, -2, i);
+            }
+            lua_setglobal(L, "Widgets");
+
+            const char* Chunk = R"(
+            for _, Widget in ipairs(Widgets) do
+                local Callbacks = {}
+                for i = 1, 10 do
+                    Callbacks[i] = function() end
+                    Widget.SimpleEvent:Add(Widget, Callbacks[i])
+                end
+                for i = 1, 10 do
+                    Widget.SimpleEvent:Remove(Widget, Callbacks[i])
+                end
+            end
+            )";
+
+            const auto Run = [&](int32 PoolSize, const TCHAR* Label)
+            {
+                const auto SavedPoolSize = GLuaDelegateHandlerPoolSize;
+                GLuaDelegateHandlerPoolSize = PoolSize;
+                CollectGarbage(RF_NoFlags, true);
+
+                const auto NumObjectsBefore = GUObjectArray.GetObjectArrayNumMinusAvailable();
+                for (auto Frame = 0; Frame < 20; Frame++)
+                {
+                    UnLua::RunChunk(L, Chunk);
+                    FCoreDelegates::OnEndFrame.Broadcast();
+                }
+                const auto NumObjectsCreated = GUObjectArray.GetObjectArrayNumMinusAvailable() - NumObjectsBefore;
+
+                const auto StartTime = FPlatformTime::Seconds();
+                CollectGarbage(RF_NoFlags, true);
+                const auto GCTime = (FPlatformTime::Seconds() - StartTime) * 1000;
+
+                GLuaDelegateHandlerPoolSize = SavedPoolSize;
+                AddInfo(FString::Printf(TEXT("%s: %d UObjects created, GC %.3fms"), Label, NumObjectsCreated, GCTime));
+                return NumObjectsCreated;
+            };
+
+            const auto NumWithoutPool = Run(0, TEXT("without pool"));
+            const auto NumWithPool = Run(1024, TEXT("with pool"));
+            TEST_TRUE(NumWithPool < NumWithoutPool);
+        });
+    });
+
     AfterEach([this]
     {
         UnLua::Shutdown();
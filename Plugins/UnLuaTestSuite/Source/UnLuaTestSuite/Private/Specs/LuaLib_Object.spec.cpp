@@ -152,6 +152,102 @@ void FUnLuaLibObjectSpec::Define()
         });
     });
 
+    Describe(TEXT("GetProperties"), [this]()
+    {
+        It(TEXT("一次读取多个属性"), EAsyncExecution::TaskGraphMainThread, [this]()
+        {
+            const char* Chunk = "\
+            local Stub = NewObject(UE.UUnLuaTestStub)\
+            Stub.Counter = 10\
+            Stub.TestName = 'Bulk'\
+            return Stub:GetProperties('Counter', 'NotExist', 'TestName')\
+            ";
+            UnLua::RunChunk(L, Chunk);
+            TEST_EQUAL((int32)lua_tointeger(L, -3), 10);
+            TEST_TRUE(lua_isnil(L, -2));
+            TEST_EQUAL(lua_tostring(L, -1), "Bulk");
+        });
+
+        It(TEXT("读取结构体的多个属性"), EAsyncExecution::TaskGraphMainThread, [this]()
+        {
+            const char* Chunk = "\
+            local Row = UE.FUnLuaTestTableRow()\
+            Row.Title = 'Row'\
+            Row.Level = 3\
+            return Row:GetProperties('Title', 'Level')\
+            ";
+            UnLua::RunChunk(L, Chunk);
+            TEST_EQUAL(lua_tostring(L, -2), "Row");
+            TEST_EQUAL((int32)lua_tointeger(L, -1), 3);
+        });
+
+        It(TEXT("一次读取大量属性"), EAsyncExecution::TaskGraphMainThread, [this]()
+        {
+            const char* Chunk = "\
+            local Stub = NewObject(UE.UUnLuaTestStub)\
+            Stub.Counter = 10\
+            Stub.TestName = 'Bulk'\
+            local Names = {}\
+            for i = 1, 500 do Names[i] = i % 2 == 0 and 'Counter' or 'TestName' end\
+            local Values = { Stub:GetProperties(table.unpack(Names)) }\
+            local NumMatched = 0\
+            for i = 1, 500 do\
+                if Values[i] == (i % 2 == 0 and 10 or 'Bulk') then NumMatched = NumMatched + 1 end\
+            end\
+            return NumMatched\
+            ";
+            UnLua::RunChunk(L, Chunk);
+            TEST_EQUAL((int32)lua_tointeger(L, -1), 500);
+        });
+    });
+
+    Describe(TEXT("SetProperties"), [this]()
+    {
+        It(TEXT("一次写入多个属性"), EAsyncExecution::TaskGraphMainThread, [this]()
+        {
+            const auto Stub = NewObject<UUnLuaTestStub>();
+            UnLua::PushUObject(L, Stub);
+            lua_setglobal(L, "G_Stub");
+
+            UnLua::RunChunk(L, "G_Stub:SetProperties({ Counter = 42, TestName = 'Bulk', NotExist = true })");
+            TEST_EQUAL(Stub->Counter, 42);
+            TEST_EQUAL(Stub->TestName, FName("Bulk"));
+        });
+
+        It(TEXT("批量读写与逐个读写的耗时对比"), EAsyncExecution::TaskGraphMainThread, [this]()
+        {
+            const char* Chunk = "\
+            local N = 200000\
+            local Stub = NewObject(UE.UUnLuaTestStub)\
+            local Clock = os.clock\
+            local Start = Clock()\
+            local Mismatches = 0\
+            for i = 1, N do\
+                Stub.Counter = i\
+                Stub.TestName = 'A'\
+                local Counter, Name = Stub.Counter, Stub.TestName\
+                if Counter ~= i or Name ~= 'A' then Mismatches = Mismatches + 1 end\
+            end\
+            local Single = Clock() - Start\
+            local Values = { Counter = 0, TestName = 'A' }\
+            Start = Clock()\
+            for i = 1, N do\
+                Values.Counter = i\
+                Stub:SetProperties(Values)\
+                local Counter, Name = Stub:GetProperties('Counter', 'TestName')\
+                if Counter ~= i or Name ~= 'A' then Mismatches = Mismatches + 1 end\
+            end\
+            return Mismatches, N, Single, Clock() - Start\
+            ";
+            UnLua::RunChunk(L, Chunk);
+            TEST_EQUAL((int32)lua_tointeger(L, -4), 0);
+            const auto N = (int32)lua_tointeger(L, -3);
+            const auto Single = lua_tonumber(L, -2);
+            const auto Bulk = lua_tonumber(L, -1);
+            AddInfo(FString::Printf(TEXT("read/write 2 properties %d times, individually: %.3fms, in bulk: %.3fms"), N, Single * 1000, Bulk * 1000));
+        });
+    });
+
     xDescribe(TEXT("Release"), [this]()
     {
         It(TEXT("释放对象在LuaVM的引用"), EAsyncExecution::TaskGraphMainThread, [this]()
@@ -15,6 +15,7 @@
 #include "UnLuaBase.h"
 #include "UnLuaTemplate.h"
 #include "UnLuaTestHelpers.h"
+#include "Registries/ReflectedTypeIndex.h"
 #include "Misc/AutomationTest.h"
 
 #if WITH_DEV_AUTOMATION_TESTS
@@ -66,6 +67,27 @@ void FUELibSpec::Define()
             TEST_EQUAL(Result1, EUnLuaTestEnum::None);
             TEST_EQUAL(Result2, EUnLuaTestEnum::Value2);
         });
+
+        It(TEXT("反射类型名字索引"), EAsyncExecution::TaskGraphMainThread, [this]()
+        {
+            Env->DoString("return UE.UUnLuaTestTypeNotExists");
+            TEST_TRUE(lua_isnil(L, -1));
+            const auto NumMisses = UnLua::FReflectedTypeIndex::GetNumMisses();
+            const auto NumMissing = UnLua::FReflectedTypeIndex::NumMissing();
+            TEST_TRUE(NumMissing > 0);
+
+            const char* Chunk = R"(
+            local StartTime = os.clock()
+            for i = 1, 10000 do
+                local Type = UE.UUnLuaTestTypeNotExists
+            end
+            return (os.clock() - StartTime) * 1000
+            )";
+            Env->DoString(Chunk);
+            AddInfo(FString::Printf(TEXT("10000 missing type lookups: %.3fms"), lua_tonumber(L, -1)));
+            TEST_EQUAL(UnLua::FReflectedTypeIndex::GetNumMisses(), NumMisses);
+            TEST_EQUAL(UnLua::FReflectedTypeIndex::NumMissing(), NumMissing);
+        });
     });
 }
 
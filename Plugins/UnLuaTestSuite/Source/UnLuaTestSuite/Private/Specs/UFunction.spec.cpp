@@ -0,0 +1,314 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+#include "UnLuaBase.h"
+#include "UnLuaTemplate.h"
+#include "UnLuaTestHelpers.h"
+#include "Misc/AutomationTest.h"
+#include "Engine/Engine.h"
+#include "ReflectionUtils/FunctionDesc.h"
+#include "Registries/DelegateRegistry.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/**
+ * Forward everything to the real allocator, counting allocations made on the game thread
+ */
+class FUnLuaTestCountingMalloc final : public FMalloc
+{
+public:
+    explicit FUnLuaTestCountingMalloc(FMalloc* InInner)
+        : Inner(InInner), NumAllocs(0)
+    {
+    }
+
+    virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+    {
+        Track();
+        return Inner->Malloc(Count, Alignment);
+    }
+
+    virtual void* TryMalloc(SIZE_T Count, uint32 Alignment) override
+    {
+        Track();
+        return Inner->TryMalloc(Count, Alignment);
+    }
+
+    virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+    {
+        if (Count > 0)
+            Track();
+        return Inner->Realloc(Original, Count, Alignment);
+    }
+
+    virtual void* TryRealloc(void* Original, SIZE_T Count, uint32 Alignment) override
+    {
+        if (Count > 0)
+            Track();
+        return Inner->TryRealloc(Original, Count, Alignment);
+    }
+
+    virtual void Free(void* Original) override { Inner->Free(Original); }
+
+    virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return Inner->QuantizeSize(Count, Alignment); }
+
+    virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return Inner->GetAllocationSize(Original, SizeOut); }
+
+    virtual void Trim(bool bTrimThreadCaches) override { Inner->Trim(bTrimThreadCaches); }
+
+    virtual void SetupTLSCachesOnCurrentThread() override { Inner->SetupTLSCachesOnCurrentThread(); }
+
+    virtual void ClearAndDisableTLSCachesOnCurrentThread() override { Inner->ClearAndDisableTLSCachesOnCurrentThread(); }
+
+    virtual bool IsInternallyThreadSafe() const override { return Inner->IsInternallyThreadSafe(); }
+
+    virtual const TCHAR* GetDescriptiveName() override { return Inner->GetDescriptiveName(); }
+
+    int32 GetNumAllocs() const { return NumAllocs; }
+
+private:
+    void Track()
+    {
+        if (IsInGameThread())
+            ++NumAllocs;
+    }
+
+    FMalloc* Inner;
+    int32 NumAllocs;
+};
+
+/**
+ * Count heap allocations made by the game thread in the scope
+ */
+class FUnLuaTestScopedAllocCounter
+{
+public:
+    FUnLuaTestScopedAllocCounter()
+        : Original(GMalloc), Counting(GMalloc)
+    {
+        GMalloc = &Counting;
+    }
+
+    ~FUnLuaTestScopedAllocCounter()
+    {
+        GMalloc = Original;
+    }
+
+    int32 GetNumAllocs() const { return Counting.GetNumAllocs(); }
+
+private:
+    FMalloc* Original;
+    FUnLuaTestCountingMalloc Counting;
+};
+
+BEGIN_DEFINE_SPEC(FUnLuaUFunctionSpec, "UnLua.API.UFunction", EAutomationTestFlags::ProductFilter | EAutomationTestFlags::ApplicationContextMask)
+    TSharedPtr<UnLua::FLuaEnv> Env;
+    lua_State* L;
+    UUnLuaTestStub* Stub;
+END_DEFINE_SPEC(FUnLuaUFunctionSpec)
+
+void FUnLuaUFunctionSpec::Define()
+{
+    BeforeEach([this]
+    {
+        Env = MakeShared<UnLua::FLuaEnv>();
+        L = Env->GetMainState();
+        Stub = NewObject<UUnLuaTestStub>();
+        UnLua::PushUObject(L, Stub);
+        lua_setglobal(L, "Stub");
+    });
+
+    AfterEach([this]
+    {
+        Env.Reset();
+        L = nullptr;
+    });
+
+    Describe(TEXT("CleanupFlags"), [this]()
+    {
+        It(TEXT("64个参数以内不分配堆内存"), EAsyncExecution::TaskGraphMainThread, [this]()
+        {
+            int32 NumAllocs;
+            {
+                FUnLuaTestScopedAllocCounter Counter;
+                FCleanupFlags CleanupFlags(false, 64);
+                for (int32 i = 0; i < 64; i++)
+                    CleanupFlags[i] = true;
+                NumAllocs = Counter.GetNumAllocs();
+            }
+            TEST_EQUAL(NumAllocs, 0);
+        });
+
+        It(TEXT("从Lua调用UFunction不分配堆内存"), EAsyncExecution::TaskGraphMainThread, [this]()
+        {
+            const auto Chunk = R"(
+            function RunCalls(N)
+                local Sum = 0
+                for i = 1, N do
+                    Sum = Stub:TestForCleanupFlags(1, 2, 3, 4, 0.5, 0.5, true, false)
+                end
+                return Sum
+            end
+            )";
+            Env->DoString(Chunk);
+
+            // warm up, the first call creates the function descriptor and the parameter arena
+            lua_getglobal(L, "RunCalls");
+            lua_pushinteger(L, 10);
+            lua_pcall(L, 1, 1, 0);
+            lua_pop(L, 1);
+
+            int32 NumAllocs;
+            {
+                lua_getglobal(L, "RunCalls");
+                lua_pushinteger(L, 1000);
+                FUnLuaTestScopedAllocCounter Counter;
+                lua_pcall(L, 1, 1, 0);
+                NumAllocs = Counter.GetNumAllocs();
+            }
+            TEST_EQUAL(lua_tointeger(L, -1), 10LL);
+            TEST_EQUAL(NumAllocs, 0);
+        });
+    });
+
+    Describe(TEXT("接口函数"), [this]()
+    {
+        It(TEXT("不同实现类交替调用时分派到正确的实现"), EAsyncExecution::TaskGraphMainThread, [this]()
+        {
+            UnLua::PushUObject(L, NewObject<UUnLuaTestInterfaceImplA>());
+            lua_setglobal(L, "A");
+            UnLua::PushUObject(L, NewObject<UUnLuaTestInterfaceImplB>());
+            lua_setglobal(L, "B");
+
+            const auto Chunk = R"(
+            function RunCalls(N)
+                local Sum = 0
+                for i = 1, N do
+                    Sum = Sum + A:GetTestValue() * 10 + B:GetTestValue()
+                end
+                return Sum
+            end
+            )";
+            Env->DoString(Chunk);
+
+            lua_getglobal(L, "RunCalls");
+            lua_pushinteger(L, 100);
+            lua_pcall(L, 1, 1, 0);
+            TEST_EQUAL(lua_tointeger(L, -1), 1200LL);
+            lua_pop(L, 1);
+
+            FFunctionDesc::InvalidateInterfaceFunctionCaches();
+
+            lua_getglobal(L, "RunCalls");
+            lua_pushinteger(L, 1);
+            lua_pcall(L, 1, 1, 0);
+            TEST_EQUAL(lua_tointeger(L, -1), 12LL);
+        });
+    });
+
+    Describe(TEXT("网络调用空间"), [this]()
+    {
+        It(TEXT("非权威端不执行BlueprintAuthorityOnly的原生函数"), EAsyncExecution::TaskGraphMainThread, [this]()
+        {
+            UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, "UnLuaTest");
+            FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+            WorldContext.SetCurrentWorld(World);
+
+            const auto Actor = World->SpawnActor<AUnLuaTestActor>();
+            UnLua::PushUObject(L, Actor);
+            lua_setglobal(L, "Actor");
+
+            Env->DoString("Actor:TestForAuthorityOnly()");
+            TEST_EQUAL(Actor->NumAuthorityOnlyCalls, 1);
+
+            Actor->SetRole(ROLE_SimulatedProxy);
+            Env->DoString("Actor:TestForAuthorityOnly()");
+            TEST_EQUAL(Actor->NumAuthorityOnlyCalls, 1);
+
+            GEngine->DestroyWorldContext(World);
+            World->DestroyWorld(false);
+        });
+    });
+
+    Describe(TEXT("跨语言调用统计"), [this]()
+    {
+        BeforeEach([this]
+        {
+            FFunctionDesc::ResetCrossingStats();
+            Env->DoString(R"(
+            function RunCalls(N)
+                for i = 1, N do
+                    Stub:TestForCleanupFlags(1, 2, 3, 4, 0.5, 0.5, true, false)
+                end
+            end
+            )");
+        });
+
+        AfterEach([this]
+        {
+            GLuaCrossingStats = false;
+            FFunctionDesc::ResetCrossingStats();
+        });
+
+        It(TEXT("关闭时不记录"), EAsyncExecution::TaskGraphMainThread, [this]()
+        {
+            GLuaCrossingStats = false;
+            Env->DoString("RunCalls(10)");
+            TEST_EQUAL(FFunctionDesc::GetCrossingRecords().Num(), 0);
+        });
+
+        It(TEXT("开启时按函数记录从Lua调用UFunction的次数和耗时"), EAsyncExecution::TaskGraphMainThread, [this]()
+        {
+            GLuaCrossingStats = true;
+            Env->DoString("RunCalls(10)");
+
+            UFunction* Function = UUnLuaTestStub::StaticClass()->FindFunctionByName(TEXT("TestForCleanupFlags"));
+            const auto Record = FFunctionDesc::GetCrossingRecords().Find(Function);
+            if (!TestNotNull(TEXT("Record"), Record))
+                return;
+            TEST_EQUAL(Record->Name, FString(TEXT("UnLuaTestStub.TestForCleanupFlags")));
+            TEST_EQUAL((int64)Record->LuaToUE.NumCalls, 10LL);
+            TEST_EQUAL((int64)Record->UEToLua.NumCalls, 0LL);
+            TEST_TRUE(Record->LuaToUE.InclusiveCycles >= Record->LuaToUE.MarshalCycles);
+
+            FFunctionDesc::ResetCrossingStats();
+            TEST_EQUAL(FFunctionDesc::GetCrossingRecords().Num(), 0);
+        });
+
+        It(TEXT("开启时记录批量广播调用的每个Lua监听者"), EAsyncExecution::TaskGraphMainThread, [this]()
+        {
+            const auto SavedBatched = GLuaBatchedBroadcast;
+            GLuaBatchedBroadcast = true;
+            GLuaCrossingStats = true;
+            Env->DoString(R"(
+            Stub.SimpleEvent:Add(Stub, function() end)
+            Stub.SimpleEvent:Add(Stub, function() end)
+            )");
+            Stub->SimpleEvent.Broadcast();
+            Stub->SimpleEvent.Broadcast();
+            GLuaBatchedBroadcast = SavedBatched;
+
+            const FMulticastDelegateProperty* Property = CastField<FMulticastDelegateProperty>(UUnLuaTestStub::StaticClass()->FindPropertyByName(TEXT("SimpleEvent")));
+            if (!TestNotNull(TEXT("Property"), Property))
+                return;
+            const auto Record = FFunctionDesc::GetCrossingRecords().Find(Property->SignatureFunction);
+            if (!TestNotNull(TEXT("Record"), Record))
+                return;
+            TEST_EQUAL((int64)Record->UEToLua.NumCalls, 4LL);
+            TEST_EQUAL((int64)Record->LuaToUE.NumCalls, 0LL);
+        });
+    });
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,62 @@
+// Tencent is pleased to support the open source community by making UnLua available.
+// 
+// Copyright (C) 2019 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); 
+// you may not use this file except in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, 
+// software distributed under the License is distributed on an "AS IS" BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and limitations under the License.
+
+#include "LuaEnv.h"
+#include "UnLuaTestCommon.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+struct FUnLuaTest_DeleteFilter : FUnLuaTestBase
+{
+    virtual bool InstantTest() override
+    {
+        return true;
+    }
+
+    virtual bool SetUp() override
+    {
+        FUnLuaTestBase::SetUp();
+
+        const auto& Filter = UnLua::FLuaEnv::FindEnvChecked(L).GetDeleteFilter();
+        const auto OldAccepted = Filter.GetNumAccepted();
+        const auto OldRejected = Filter.GetNumRejected();
+
+        const TCHAR* MapNames[] = {
+            TEXT("/UnLuaTestSuite/Tests/Regression/Issue343/Map1"),
+            TEXT("/UnLuaTestSuite/Tests/Regression/Issue343/Map2"),
+            TEXT("/UnLuaTestSuite/Tests/Regression/Issue343/Map3"),
+        };
+
+        const auto StartTime = FPlatformTime::Seconds();
+        for (int32 i = 0; i < 10; i++)
+        {
+            LoadMap(MapNames[i % UE_ARRAY_COUNT(MapNames)]);
+            SimulateTick(0.1f);
+            CollectGarbage(RF_NoFlags, true);
+        }
+        const auto Elapsed = FPlatformTime::Seconds() - StartTime;
+
+        const auto Accepted = Filter.GetNumAccepted() - OldAccepted;
+        const auto Rejected = Filter.GetNumRejected() - OldRejected;
+        GetTestRunner().AddInfo(FString::Printf(TEXT("streamed 10 maps in %.3fms, delete notifications accepted: %llu, rejected: %llu, reject rate: %.2f%%"),
+                                                Elapsed * 1000, Accepted, Rejected, Accepted + Rejected > 0 ? 100.0 * Rejected / (Accepted + Rejected) : 0.0));
+        RUNNER_TEST_TRUE(Rejected > Accepted);
+        return true;
+    }
+};
+
+IMPLEMENT_UNLUA_INSTANT_TEST(FUnLuaTest_DeleteFilter, TEXT("UnLua.API.DeleteFilter 反复切换关卡时过滤无关对象的删除通知"))
+
+#endif //WITH_DEV_AUTOMATION_TESTS
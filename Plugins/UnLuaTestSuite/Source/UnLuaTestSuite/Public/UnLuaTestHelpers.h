@@ -25,6 +25,8 @@
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FUnLuaTestSimpleEvent);
 
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FUnLuaTestPayloadEvent, int32, Value, FVector, Location);
+
 DECLARE_DYNAMIC_DELEGATE(FUnLuaTestSimpleHandler);
 
 DECLARE_DYNAMIC_DELEGATE_RetVal_OneParam(int32, FUnLuaTestComplexHandler, FString&, Name);
@@ -73,6 +75,9 @@ public:
     UPROPERTY()
     FUnLuaTestSimpleEvent SimpleEvent;
 
+    UPROPERTY()
+    FUnLuaTestPayloadEvent PayloadEvent;
+
     UPROPERTY()
     FUnLuaTestSimpleHandler SimpleHandler;
 
@@ -88,6 +93,9 @@ public:
     UPROPERTY()
     int32 Counter;
 
+    UPROPERTY()
+    FName TestName;
+
     EScopedEnum::Type ScopedEnum;
 
     EEnumClass EnumClass;
@@ -108,6 +116,59 @@ public:
 
     UFUNCTION(BlueprintCallable)
     int32 TestForIssue407(TArray<int32> Array);
+
+    UFUNCTION(BlueprintCallable)
+    int32 TestForCleanupFlags(int32 A, int32 B, int32 C, int32 D, float E, float F, bool G, bool H) { return A + B + C + D; }
+
+    UFUNCTION()
+    void NativeListener() { if (NativeListenerCallback) NativeListenerCallback(); }
+
+    TFunction<void()> NativeListenerCallback;
+};
+
+UINTERFACE()
+class UNLUATESTSUITE_API UUnLuaTestInterface : public UInterface
+{
+    GENERATED_BODY()
+};
+
+class UNLUATESTSUITE_API IUnLuaTestInterface
+{
+    GENERATED_BODY()
+
+public:
+    UFUNCTION(BlueprintNativeEvent, BlueprintCallable)
+    int32 GetTestValue() const;
+};
+
+UCLASS()
+class UNLUATESTSUITE_API UUnLuaTestInterfaceImplA : public UObject, public IUnLuaTestInterface
+{
+    GENERATED_BODY()
+
+public:
+    virtual int32 GetTestValue_Implementation() const override { return 1; }
+};
+
+UCLASS()
+class UNLUATESTSUITE_API UUnLuaTestInterfaceImplB : public UObject, public IUnLuaTestInterface
+{
+    GENERATED_BODY()
+
+public:
+    virtual int32 GetTestValue_Implementation() const override { return 2; }
+};
+
+UCLASS()
+class UNLUATESTSUITE_API UUnLuaTestBindingStub : public UObject, public IUnLuaInterface
+{
+    GENERATED_BODY()
+
+public:
+    virtual FString GetModuleName_Implementation() const override
+    {
+        return TEXT("Tests.Binding.BindingStub");
+    }
 };
 
 UCLASS()
@@ -149,6 +210,15 @@ public:
 
     UFUNCTION(BlueprintImplementableEvent)
     TSubclassOf<UUserWidget> TestForIssue445(int32 Index);
+
+    UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly)
+    void TestForAuthorityOnly()
+    {
+        ++NumAuthorityOnlyCalls;
+    }
+
+    UPROPERTY()
+    int32 NumAuthorityOnlyCalls = 0;
 };
 
 USTRUCT(BlueprintType)